@@ -0,0 +1,62 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// number of calls to `operator new` observed so far. Allocations made on the Rust side of the
+// library go through `malloc` directly and are not counted here; use the peak-RSS metric to keep
+// track of those
+static std::size_t allocation_count = 0;
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+// monotonic wall-clock time in seconds; only differences of two calls are meaningful
+inline double wall_time() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// peak resident set size of this process in kibibytes
+inline long peak_rss_kib() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// every metric is printed as a single `key=value` line so that the output can be parsed by
+// scripts tracking performance over time
+inline void print_metric(char const* key, double value) {
+    std::printf("%s=%.6g\n", key, value);
+}
+
+inline void print_metric(char const* key, std::size_t value) {
+    std::printf("%s=%zu\n", key, value);
+}
+
+inline void print_metric(char const* key, long value) {
+    std::printf("%s=%ld\n", key, value);
+}
+
+#endif
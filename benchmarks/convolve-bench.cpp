@@ -0,0 +1,129 @@
+#include "bench.hpp"
+
+#include <LHAPDF/PDF.h>
+#include <pineappl_capi.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::string filename = "../examples/cpp/drell-yan-rap-ll.pineappl.lz4";
+    std::string pdfset = "NNPDF31_nlo_as_0118_luxqed";
+    std::size_t repeats = 100;
+
+    switch (argc) {
+    case 4:
+        repeats = std::strtoul(argv[3], nullptr, 10);
+        // fall through
+    case 3:
+        pdfset = argv[2];
+        // fall through
+    case 2:
+        filename = argv[1];
+    case 1:
+        break;
+
+    default:
+        std::cout << "Usage: " << argv[0] << " [grid] [pdf] [repeats]\n";
+        return EXIT_FAILURE;
+    }
+
+    // disable LHAPDF banners to guarantee machine-readable output
+    LHAPDF::setVerbosity(0);
+
+    auto* grid = pineappl_grid_read(filename.c_str());
+
+    auto* pdf = LHAPDF::mkPDF(pdfset, 0);
+
+    auto xfx = [](int32_t id, double x, double q2, void* pdf) {
+        return static_cast <LHAPDF::PDF*> (pdf)->xfxQ2(id, x, q2);
+    };
+    auto alphas = [](double q2, void* pdf) {
+        return static_cast <LHAPDF::PDF*> (pdf)->alphasQ2(q2);
+    };
+
+    std::size_t bins = pineappl_grid_bin_count(grid);
+    std::size_t orders = pineappl_grid_order_count(grid);
+
+    auto* lumi = pineappl_grid_lumi(grid);
+    std::size_t channels = pineappl_lumi_count(lumi);
+    pineappl_lumi_delete(lumi);
+
+    std::vector<double> dxsec(bins);
+
+    print_metric("convolve.bins", bins);
+    print_metric("convolve.repeats", repeats);
+
+    // 1) plain convolution with a single PDF, all orders and channels
+
+    double start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_convolve_with_one(grid, 2212, xfx, alphas, pdf, nullptr, nullptr, 1.0, 1.0,
+            dxsec.data());
+    }
+
+    double elapsed = wall_time() - start;
+
+    print_metric("convolve.single.seconds", elapsed);
+    print_metric("convolve.single.bins_per_second", repeats * bins / elapsed);
+
+    // 2) convolution restricted to the leading order and the first channel
+
+    std::vector<bool> order_mask(orders, false);
+    std::vector<bool> channel_mask(channels, false);
+    order_mask.front() = true;
+    channel_mask.front() = true;
+
+    // `std::vector<bool>` is a bitset and has no `data()` returning `bool*`
+    std::vector<char> order_mask_raw(order_mask.begin(), order_mask.end());
+    std::vector<char> channel_mask_raw(channel_mask.begin(), channel_mask.end());
+
+    start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_convolve_with_one(grid, 2212, xfx, alphas, pdf,
+            reinterpret_cast <bool*> (order_mask_raw.data()),
+            reinterpret_cast <bool*> (channel_mask_raw.data()), 1.0, 1.0, dxsec.data());
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("convolve.masked.seconds", elapsed);
+    print_metric("convolve.masked.bins_per_second", repeats * bins / elapsed);
+
+    // 3) the customary 7-point scale variation around the central scales
+
+    double const xi[] = {
+        1.0, 1.0,
+        2.0, 2.0,
+        0.5, 0.5,
+        2.0, 1.0,
+        1.0, 2.0,
+        0.5, 1.0,
+        1.0, 0.5,
+    };
+    std::size_t points = 7;
+
+    start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        for (std::size_t j = 0; j != points; ++j) {
+            pineappl_grid_convolve_with_one(grid, 2212, xfx, alphas, pdf, nullptr, nullptr,
+                xi[2 * j + 0], xi[2 * j + 1], dxsec.data());
+        }
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("convolve.scale_variation.seconds", elapsed);
+    print_metric("convolve.scale_variation.bins_per_second", repeats * points * bins / elapsed);
+
+    print_metric("convolve.peak_rss_kib", peak_rss_kib());
+
+    delete pdf;
+    pineappl_grid_delete(grid);
+}
@@ -0,0 +1,219 @@
+#include "bench.hpp"
+
+#include <pineappl_capi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+double int_photo(double s, double t, double u) {
+    double alpha0 = 1.0 / 137.03599911;
+    return alpha0 * alpha0 / 2.0 / s * (t / u + u / t);
+}
+
+struct Psp2to2 {
+    double s;
+    double t;
+    double u;
+    double x1;
+    double x2;
+    double jacobian;
+};
+
+Psp2to2 hadronic_pspgen(std::mt19937& rng, double mmin, double mmax) {
+    using std::acos;
+    using std::log;
+    using std::pow;
+
+    double smin = mmin * mmin;
+    double smax = mmax * mmax;
+
+    double r1 = std::generate_canonical<double, 53>(rng);
+    double r2 = std::generate_canonical<double, 53>(rng);
+    double r3 = std::generate_canonical<double, 53>(rng);
+
+    double tau0 = smin / smax;
+    double tau = pow(tau0, r1);
+    double y = pow(tau, 1.0 - r2);
+    double x1 = y;
+    double x2 = tau / y;
+    double s = tau * smax;
+
+    double jacobian = tau * log(tau0) * log(tau0) * r1;
+
+    double cos_theta = 2.0 * r3 - 1.0;
+    jacobian *= 2.0;
+
+    double t = -0.5 * s * (1.0 - cos_theta);
+    double u = -0.5 * s * (1.0 + cos_theta);
+
+    jacobian *= 2.0 * acos(-1.0);
+
+    return { s, t, u, x1, x2, jacobian };
+}
+
+struct Event {
+    double x1;
+    double x2;
+    double q2;
+    double observable;
+    double weight;
+};
+
+// generate the same Drell-Yan lepton-pair events as `examples/cpp/fill-grid.cpp`, but buffer them
+// so that the per-event and the array fill paths see exactly the same input
+std::vector<Event> generate_events(std::size_t calls) {
+    using std::acosh;
+    using std::fabs;
+    using std::log;
+    using std::sqrt;
+
+    auto rng = std::mt19937();
+
+    // in GeV^2 pbarn
+    double hbarc2 = 389379372.1;
+
+    std::vector<Event> events;
+    events.reserve(calls);
+
+    for (std::size_t i = 0; i != calls; ++i) {
+        auto tmp = hadronic_pspgen(rng, 10.0, 7000.0);
+        auto s = tmp.s;
+        auto t = tmp.t;
+        auto u = tmp.u;
+        auto x1 = tmp.x1;
+        auto x2 = tmp.x2;
+        auto jacobian = tmp.jacobian;
+
+        double ptl = sqrt((t * u / s));
+        double mll = sqrt(s);
+        double yll = 0.5 * log(x1 / x2);
+        double ylp = fabs(yll + acosh(0.5 * mll / ptl));
+        double ylm = fabs(yll - acosh(0.5 * mll / ptl));
+
+        jacobian *= hbarc2 / calls;
+
+        // cuts for LO for the invariant-mass slice containing the Z-peak from CMSDY2D11
+        if ((ptl < 14.0) || (fabs(yll) > 2.4) || (ylp > 2.4)
+            || (ylm > 2.4) || (mll < 60.0) || (mll > 120.0))
+        {
+            continue;
+        }
+
+        double weight = jacobian * int_photo(s, t, u);
+        double q2 = 90.0 * 90.0;
+
+        events.push_back({ x1, x2, q2, fabs(yll), weight });
+    }
+
+    return events;
+}
+
+pineappl_grid* create_grid() {
+    auto* channels = pineappl_lumi_new();
+
+    int32_t pids[] = { 22, 22 };
+    pineappl_lumi_add(channels, 1, pids, nullptr);
+
+    uint32_t orders[] = { 0, 2, 0, 0 };
+
+    std::vector<double> bins = {
+        0.0,
+        0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2,
+        1.3, 1.4, 1.5, 1.6, 1.7, 1.8, 1.9, 2.0, 2.1, 2.2, 2.3, 2.4
+    };
+
+    auto* keyval = pineappl_keyval_new();
+    auto* grid = pineappl_grid_new(channels, 1, orders, bins.size() - 1, bins.data(), keyval);
+    pineappl_keyval_delete(keyval);
+    pineappl_lumi_delete(channels);
+
+    return grid;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t calls = 1000000;
+    std::size_t batch_size = 10000;
+
+    switch (argc) {
+    case 3:
+        batch_size = std::strtoul(argv[2], nullptr, 10);
+        // fall through
+    case 2:
+        calls = std::strtoul(argv[1], nullptr, 10);
+    case 1:
+        break;
+
+    default:
+        std::cout << "Usage: " << argv[0] << " [events] [batch-size]\n";
+        return EXIT_FAILURE;
+    }
+
+    auto events = generate_events(calls);
+
+    print_metric("fill.events", events.size());
+    print_metric("fill.batch_size", batch_size);
+
+    // 1) fill one event at a time using `pineappl_grid_fill`
+
+    auto* grid1 = create_grid();
+    std::size_t allocations = allocation_count;
+    double start = wall_time();
+
+    for (auto const& event : events) {
+        pineappl_grid_fill(grid1, event.x1, event.x2, event.q2, 0, event.observable, 0,
+            event.weight);
+    }
+
+    double elapsed = wall_time() - start;
+
+    print_metric("fill.per_event.seconds", elapsed);
+    print_metric("fill.per_event.events_per_second", events.size() / elapsed);
+    print_metric("fill.per_event.allocations", allocation_count - allocations);
+
+    // 2) fill batches of events using `pineappl_grid_fill_array`
+
+    auto* grid2 = create_grid();
+
+    std::vector<double> x1(batch_size);
+    std::vector<double> x2(batch_size);
+    std::vector<double> q2(batch_size);
+    std::vector<double> observables(batch_size);
+    std::vector<double> weights(batch_size);
+    std::vector<std::size_t> orders(batch_size, 0);
+    std::vector<std::size_t> channels(batch_size, 0);
+
+    allocations = allocation_count;
+    start = wall_time();
+
+    for (std::size_t offset = 0; offset < events.size(); offset += batch_size) {
+        std::size_t size = std::min(batch_size, events.size() - offset);
+
+        for (std::size_t i = 0; i != size; ++i) {
+            auto const& event = events.at(offset + i);
+            x1.at(i) = event.x1;
+            x2.at(i) = event.x2;
+            q2.at(i) = event.q2;
+            observables.at(i) = event.observable;
+            weights.at(i) = event.weight;
+        }
+
+        pineappl_grid_fill_array(grid2, x1.data(), x2.data(), q2.data(), orders.data(),
+            observables.data(), channels.data(), weights.data(), size);
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("fill.array.seconds", elapsed);
+    print_metric("fill.array.events_per_second", events.size() / elapsed);
+    print_metric("fill.array.allocations", allocation_count - allocations);
+
+    print_metric("fill.peak_rss_kib", peak_rss_kib());
+
+    pineappl_grid_delete(grid1);
+    pineappl_grid_delete(grid2);
+}
@@ -0,0 +1,91 @@
+#include "bench.hpp"
+
+#include <pineappl_capi.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string filename = "../examples/cpp/drell-yan-rap-ll.pineappl.lz4";
+    std::size_t repeats = 20;
+
+    switch (argc) {
+    case 3:
+        repeats = std::strtoul(argv[2], nullptr, 10);
+        // fall through
+    case 2:
+        filename = argv[1];
+    case 1:
+        break;
+
+    default:
+        std::cout << "Usage: " << argv[0] << " [grid] [repeats]\n";
+        return EXIT_FAILURE;
+    }
+
+    auto* grid = pineappl_grid_read(filename.c_str());
+
+    print_metric("io.repeats", repeats);
+
+    // 1) write the grid compressed (the `.lz4` suffix selects the compression)
+
+    std::string compressed = "io-bench.pineappl.lz4";
+    double start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_write(grid, compressed.c_str());
+    }
+
+    double elapsed = wall_time() - start;
+
+    print_metric("io.write_lz4.seconds", elapsed);
+    print_metric("io.write_lz4.grids_per_second", repeats / elapsed);
+
+    // 2) write the grid uncompressed
+
+    std::string uncompressed = "io-bench.pineappl";
+    start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_write(grid, uncompressed.c_str());
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("io.write.seconds", elapsed);
+    print_metric("io.write.grids_per_second", repeats / elapsed);
+
+    // 3) read both variants back
+
+    start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_delete(pineappl_grid_read(compressed.c_str()));
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("io.read_lz4.seconds", elapsed);
+    print_metric("io.read_lz4.grids_per_second", repeats / elapsed);
+
+    start = wall_time();
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        pineappl_grid_delete(pineappl_grid_read(uncompressed.c_str()));
+    }
+
+    elapsed = wall_time() - start;
+
+    print_metric("io.read.seconds", elapsed);
+    print_metric("io.read.grids_per_second", repeats / elapsed);
+
+    print_metric("io.peak_rss_kib", peak_rss_kib());
+
+    std::remove(compressed.c_str());
+    std::remove(uncompressed.c_str());
+
+    pineappl_grid_delete(grid);
+}
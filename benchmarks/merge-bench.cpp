@@ -0,0 +1,54 @@
+#include "bench.hpp"
+
+#include <pineappl_capi.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string filename = "../examples/cpp/drell-yan-rap-ll.pineappl.lz4";
+    std::size_t repeats = 50;
+
+    switch (argc) {
+    case 3:
+        repeats = std::strtoul(argv[2], nullptr, 10);
+        // fall through
+    case 2:
+        filename = argv[1];
+    case 1:
+        break;
+
+    default:
+        std::cout << "Usage: " << argv[0] << " [grid] [repeats]\n";
+        return EXIT_FAILURE;
+    }
+
+    auto* grid = pineappl_grid_read(filename.c_str());
+
+    print_metric("merge.repeats", repeats);
+
+    // merge clones of the grid into an accumulator, which is what a typical production setup does
+    // with the grids written by independent Monte Carlo runs. Cloning is not part of the timed
+    // region
+
+    auto* accumulator = pineappl_grid_clone(grid);
+    double total = 0.0;
+
+    for (std::size_t i = 0; i != repeats; ++i) {
+        auto* clone = pineappl_grid_clone(grid);
+
+        double start = wall_time();
+        pineappl_grid_merge_and_delete(accumulator, clone);
+        total += wall_time() - start;
+    }
+
+    print_metric("merge.seconds", total);
+    print_metric("merge.merges_per_second", repeats / total);
+
+    print_metric("merge.peak_rss_kib", peak_rss_kib());
+
+    pineappl_grid_delete(accumulator);
+    pineappl_grid_delete(grid);
+}
@@ -4,7 +4,7 @@ use super::convert::{f64_from_usize, usize_from_f64};
 use float_cmp::approx_eq;
 use itertools::izip;
 use itertools::Itertools;
-use serde::{Deserialize, Serialize};
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
 use std::f64;
 use std::ops::Range;
 use std::str::FromStr;
@@ -55,9 +55,79 @@ pub enum MergeBinError {
     },
 }
 
+/// Eytzinger-layout copy of unequally spaced bin limits, together with the rank of each limit in
+/// sorted order. It is rebuilt whenever the limits change and is not serialized; it allows
+/// [`BinLimits::index`] to find the bin with a branch-free search instead of a binary search.
+#[derive(Clone, Debug, Default)]
+struct Eytzinger {
+    limits: Vec<f64>,
+    ranks: Vec<usize>,
+}
+
+impl Eytzinger {
+    fn new(sorted: &[f64]) -> Self {
+        let mut result = Self {
+            limits: vec![0.0; sorted.len()],
+            ranks: vec![0; sorted.len()],
+        };
+        result.fill(sorted, &mut 0, 1);
+        result
+    }
+
+    fn fill(&mut self, sorted: &[f64], rank: &mut usize, node: usize) {
+        if node <= sorted.len() {
+            self.fill(sorted, rank, 2 * node);
+            self.limits[node - 1] = sorted[*rank];
+            self.ranks[node - 1] = *rank;
+            *rank += 1;
+            self.fill(sorted, rank, 2 * node + 1);
+        }
+    }
+
+    /// Returns the rank of the smallest limit that is larger than `value`, or `None` if there is
+    /// none. The loop descends the implicit binary tree; the comparison result only feeds into an
+    /// index calculation and never into a branch.
+    fn upper_bound(&self, value: f64) -> Option<usize> {
+        let mut node = 1;
+
+        while node <= self.limits.len() {
+            node = 2 * node + usize::from(self.limits[node - 1] <= value);
+        }
+
+        // the bits of `node` encode the turns taken; cancel the trailing right turns and one left
+        // turn to recover the node of the last limit that was larger than `value`
+        node >>= node.trailing_ones() + 1;
+
+        (node > 0).then(|| self.ranks[node - 1])
+    }
+}
+
 /// Structure representing bin limits.
-#[derive(Clone, Debug, Deserialize, PartialEq, Serialize)]
-pub struct BinLimits(Limits);
+#[derive(Clone, Debug)]
+pub struct BinLimits {
+    limits: Limits,
+    eytzinger: Eytzinger,
+}
+
+impl PartialEq for BinLimits {
+    fn eq(&self, other: &Self) -> bool {
+        self.limits == other.limits
+    }
+}
+
+impl Serialize for BinLimits {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        // serialize only the limits, so that the on-disk format is the same as for the previous
+        // newtype definition of this struct; the Eytzinger layout is rebuilt when reading
+        self.limits.serialize(serializer)
+    }
+}
+
+impl<'de> Deserialize<'de> for BinLimits {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        Limits::deserialize(deserializer).map(Self::from_limits)
+    }
+}
 
 /// Error type that is returned by the constructor of `BinRemapper`.
 #[derive(Debug, Error)]
@@ -592,20 +662,32 @@ impl BinLimits {
             .windows(2)
             .all(|val| approx_eq!(f64, val[0], val[1], ulps = 8))
         {
-            Self(Limits::Equal {
+            Self::from_limits(Limits::Equal {
                 left: *limits.first().unwrap(),
                 right: *limits.last().unwrap(),
                 bins: limits.len() - 1,
             })
         } else {
-            Self(Limits::Unequal { limits })
+            Self::from_limits(Limits::Unequal { limits })
         }
     }
 
+    /// Constructs `Self` from `limits`, precomputing the lookup structure used by
+    /// [`BinLimits::index`]: equally spaced limits are found with a multiplication, unequally
+    /// spaced ones with a branch-free search in an Eytzinger-layout copy of the limits.
+    fn from_limits(limits: Limits) -> Self {
+        let eytzinger = match &limits {
+            Limits::Equal { .. } => Eytzinger::default(),
+            Limits::Unequal { limits } => Eytzinger::new(limits),
+        };
+
+        Self { limits, eytzinger }
+    }
+
     /// Returns the number of bins.
     #[must_use]
     pub fn bins(&self) -> usize {
-        match &self.0 {
+        match &self.limits {
             Limits::Equal { bins, .. } => *bins,
             Limits::Unequal { limits } => limits.len() - 1,
         }
@@ -619,7 +701,7 @@ impl BinLimits {
     /// TODO
     #[must_use]
     pub fn index(&self, value: f64) -> Option<usize> {
-        match &self.0 {
+        match &self.limits {
             Limits::Equal { left, right, bins } => {
                 if value < *left || value >= *right {
                     None
@@ -629,14 +711,13 @@ impl BinLimits {
                     ))
                 }
             }
-            Limits::Unequal { limits } => {
-                match limits.binary_search_by(|left| left.partial_cmp(&value).unwrap()) {
-                    Err(0) => None,
-                    Err(index) if index == limits.len() => None,
-                    Ok(index) if index == (limits.len() - 1) => None,
-                    Ok(index) => Some(index),
-                    Err(index) => Some(index - 1),
-                }
+            Limits::Unequal { .. } => {
+                // the rank of the smallest limit larger than `value`; `None` if `value` is equal
+                // to or larger than the right-most limit
+                let rank = self.eytzinger.upper_bound(value)?;
+
+                // a rank of zero means `value` underflows the left-most limit
+                (rank > 0).then(|| rank - 1)
             }
         }
     }
@@ -648,7 +729,7 @@ impl BinLimits {
     /// TODO
     #[must_use]
     pub fn left(&self) -> f64 {
-        match &self.0 {
+        match &self.limits {
             Limits::Unequal { limits } => *limits.first().unwrap(),
             Limits::Equal { left, .. } => *left,
         }
@@ -671,7 +752,7 @@ impl BinLimits {
     /// ```
     #[must_use]
     pub fn limits(&self) -> Vec<f64> {
-        match &self.0 {
+        match &self.limits {
             Limits::Equal { left, right, bins } => (0..=*bins)
                 .map(|b| (*right - *left).mul_add(f64_from_usize(b) / f64_from_usize(*bins), *left))
                 .collect(),
@@ -717,7 +798,7 @@ impl BinLimits {
     /// ```
     #[must_use]
     pub fn bin_sizes(&self) -> Vec<f64> {
-        match &self.0 {
+        match &self.limits {
             Limits::Equal { left, right, bins } => {
                 vec![(*right - *left) / f64_from_usize(*bins); *bins]
             }
@@ -766,7 +847,7 @@ impl BinLimits {
     /// TODO
     #[must_use]
     pub fn right(&self) -> f64 {
-        match &self.0 {
+        match &self.limits {
             Limits::Unequal { limits } => *limits.last().unwrap(),
             Limits::Equal { right, .. } => *right,
         }
@@ -792,6 +873,25 @@ mod test {
     use super::*;
     use std::iter;
 
+    #[test]
+    fn bin_limits_unequal_index() {
+        // sizes from 2 to 18 bins cover implicit trees of different shapes, including incomplete
+        // ones; quadratically growing limits are never equally spaced
+        for bins in 2..=18 {
+            let limits: Vec<f64> = (0..=bins).map(|i| f64_from_usize(i * i)).collect();
+            let bin_limits = BinLimits::new(limits.clone());
+
+            assert_eq!(bin_limits.index(-0.5), None);
+            assert_eq!(bin_limits.index(*limits.last().unwrap()), None);
+            assert_eq!(bin_limits.index(*limits.last().unwrap() + 1.0), None);
+
+            for (bin, window) in limits.windows(2).enumerate() {
+                assert_eq!(bin_limits.index(window[0]), Some(bin));
+                assert_eq!(bin_limits.index(0.5 * (window[0] + window[1])), Some(bin));
+            }
+        }
+    }
+
     #[test]
     fn bin_limits_merge() {
         let mut limits = BinLimits::new(vec![0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0]);
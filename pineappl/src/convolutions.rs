@@ -51,6 +51,7 @@ pub struct LumiCache<'a> {
     pdg2: i32,
     cc1: i32,
     cc2: i32,
+    evaluations: u64,
 }
 
 impl<'a> LumiCache<'a> {
@@ -87,6 +88,7 @@ impl<'a> LumiCache<'a> {
             pdg2,
             cc1: 0,
             cc2: 0,
+            evaluations: 0,
         }
     }
 
@@ -119,6 +121,7 @@ impl<'a> LumiCache<'a> {
             pdg2: pdg,
             cc1: 0,
             cc2: 0,
+            evaluations: 0,
         }
     }
 
@@ -245,9 +248,11 @@ impl<'a> LumiCache<'a> {
                     xfx1, xfx1_cache, ..
                 } => (xfx1, xfx1_cache),
             };
-            *xfx_cache
-                .entry((pid, ix1, imuf2))
-                .or_insert_with(|| xfx(pid, x, muf2))
+            let evaluations = &mut self.evaluations;
+            *xfx_cache.entry((pid, ix1, imuf2)).or_insert_with(|| {
+                *evaluations += 1;
+                xfx(pid, x, muf2)
+            })
         }
     }
 
@@ -271,9 +276,11 @@ impl<'a> LumiCache<'a> {
                     xfx2, xfx2_cache, ..
                 } => (xfx2, xfx2_cache),
             };
-            *xfx_cache
-                .entry((pid, ix2, imuf2))
-                .or_insert_with(|| xfx(pid, x, muf2))
+            let evaluations = &mut self.evaluations;
+            *xfx_cache.entry((pid, ix2, imuf2)).or_insert_with(|| {
+                *evaluations += 1;
+                xfx(pid, x, muf2)
+            })
         }
     }
 
@@ -283,6 +290,13 @@ impl<'a> LumiCache<'a> {
         self.alphas_cache[self.imur2[imu2]]
     }
 
+    /// Return the number of times the PDF callbacks were invoked so far; lookups answered by the
+    /// cache are not counted. The counter is monotone and survives [`LumiCache::clear`].
+    #[must_use]
+    pub const fn evaluations(&self) -> u64 {
+        self.evaluations
+    }
+
     /// Clears the cache.
     pub fn clear(&mut self) {
         self.alphas_cache.clear();
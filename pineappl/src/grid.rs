@@ -10,6 +10,7 @@ use super::import_only_subgrid::ImportOnlySubgridV2;
 use super::lagrange_subgrid::{LagrangeSparseSubgridV1, LagrangeSubgridV1, LagrangeSubgridV2};
 use super::ntuple_subgrid::NtupleSubgridV1;
 use super::pids::{self, PidBasis};
+use super::single_precision_subgrid::SinglePrecisionSubgridV1;
 use super::subgrid::{ExtraSubgridParams, Mu2, Subgrid, SubgridEnum, SubgridParams};
 use bitflags::bitflags;
 use float_cmp::approx_eq;
@@ -19,10 +20,11 @@ use ndarray::{s, Array3, ArrayView3, ArrayView5, ArrayViewMut3, Axis, CowArray,
 use serde::{Deserialize, Serialize, Serializer};
 use std::borrow::Cow;
 use std::collections::{BTreeMap, HashMap};
-use std::io::{self, BufRead, BufReader, BufWriter, Read, Write};
+use std::io::{self, BufRead, BufReader, BufWriter, Read, Seek, SeekFrom, Write};
 use std::iter;
 use std::mem;
 use std::ops::Range;
+use std::sync::atomic::{AtomicU64, Ordering};
 use thiserror::Error;
 
 /// This structure represents a position (`x1`, `x2`, `q2`) in a `Subgrid` together with a
@@ -69,6 +71,9 @@ pub enum GridError {
     /// Returned while performing IO operations.
     #[error(transparent)]
     IoFailure(io::Error),
+    /// Returned when trying to read the metadata footer of a file that does not have one.
+    #[error("the file does not contain a metadata footer")]
+    FooterMissing,
     /// Returned when trying to read a `PineAPPL` file with file format version that is not
     /// supported.
     #[error("the file version is {file_version}, but supported is only {supported_version}")]
@@ -208,9 +213,168 @@ bitflags! {
         const MERGE_SAME_CHANNELS = 0b10000;
         /// Remove all channels ([`Grid::channels`]), which do not contain any non-zero subgrids.
         const STRIP_EMPTY_CHANNELS = 0b10_0000;
+        /// Store the subgrid weights in single precision, which halves the memory footprint and
+        /// the size of written grid files. This rounds the weights and is therefore never applied
+        /// by [`Grid::optimize`]; it must be requested explicitly via [`Grid::optimize_using`].
+        const USE_SINGLE_PRECISION = 0b100_0000;
     }
 }
 
+/// Magic bytes that terminate the metadata footer of a grid file.
+const FOOTER_MAGIC: [u8; 16] = *b"PineAPPL-footer\0";
+
+/// Subset of the information stored in a [`Grid`] that can be read from the metadata footer of a
+/// grid file without decompressing the subgrid data. See [`Grid::read_footer`].
+#[derive(Clone, Deserialize, Serialize)]
+pub struct GridFooter {
+    /// Channels of the grid. See [`Grid::channels`].
+    pub channels: Vec<Channel>,
+    /// Bin limits of the grid.
+    pub bin_limits: BinLimits,
+    /// Perturbative orders of the grid. See [`Grid::orders`].
+    pub orders: Vec<Order>,
+    /// Metadata key-value pairs of the grid. See [`Grid::key_values`].
+    pub key_values: Option<HashMap<String, String>>,
+}
+
+/// Instrumentation counters for the hot paths of a [`Grid`]. The counters are incremented with
+/// relaxed atomic operations, which are cheap enough to leave enabled in production runs. They
+/// are not serialized and start at zero for every newly created or deserialized `Grid`; cloning a
+/// grid copies the counter values.
+#[derive(Debug, Default)]
+pub struct GridStats {
+    fill_calls: AtomicU64,
+    bin_search_misses: AtomicU64,
+    subgrid_allocations: AtomicU64,
+    pdf_evaluations: AtomicU64,
+    convolve_nodes: AtomicU64,
+}
+
+impl Clone for GridStats {
+    fn clone(&self) -> Self {
+        Self {
+            fill_calls: AtomicU64::new(self.fill_calls()),
+            bin_search_misses: AtomicU64::new(self.bin_search_misses()),
+            subgrid_allocations: AtomicU64::new(self.subgrid_allocations()),
+            pdf_evaluations: AtomicU64::new(self.pdf_evaluations()),
+            convolve_nodes: AtomicU64::new(self.convolve_nodes()),
+        }
+    }
+}
+
+impl GridStats {
+    /// Number of events passed to [`Grid::fill`] and its variants.
+    pub fn fill_calls(&self) -> u64 {
+        self.fill_calls.load(Ordering::Relaxed)
+    }
+
+    /// Number of fill calls whose observable fell outside of the bin limits.
+    pub fn bin_search_misses(&self) -> u64 {
+        self.bin_search_misses.load(Ordering::Relaxed)
+    }
+
+    /// Number of subgrids that were instantiated from the subgrid template while filling.
+    pub fn subgrid_allocations(&self) -> u64 {
+        self.subgrid_allocations.load(Ordering::Relaxed)
+    }
+
+    /// Number of PDF callback invocations performed during convolutions. Lookups answered by the
+    /// cache of [`LumiCache`] are not counted.
+    pub fn pdf_evaluations(&self) -> u64 {
+        self.pdf_evaluations.load(Ordering::Relaxed)
+    }
+
+    /// Number of subgrid nodes evaluated during convolutions.
+    pub fn convolve_nodes(&self) -> u64 {
+        self.convolve_nodes.load(Ordering::Relaxed)
+    }
+}
+
+/// Dense table of PDF values at the interpolation nodes of a grid, created by
+/// [`Grid::pdf_node_table`] and consumed by [`Grid::convolve_with_table`]. The node lists are
+/// extracted from the grid once; the caller evaluates its PDF at every `(pid, x, muf2)`
+/// combination and the strong coupling at every `mur2` value, after which the convolution is a
+/// pure lookup-and-multiply over the table without any callbacks. This is the fastest way to
+/// repeatedly convolve the same grid with changing PDFs, as is done in fitting loops. The table
+/// must be rebuilt after the grid has been modified.
+#[derive(Clone)]
+pub struct PdfNodeTable {
+    pids: Vec<i32>,
+    x: Vec<f64>,
+    muf2: Vec<f64>,
+    mur2: Vec<f64>,
+    values: Vec<f64>,
+    alphas: Vec<f64>,
+}
+
+impl PdfNodeTable {
+    /// Return the PDG ids for which PDF values must be supplied.
+    #[must_use]
+    pub fn pids(&self) -> &[i32] {
+        &self.pids
+    }
+
+    /// Return the unique momentum fractions of the grid's interpolation nodes.
+    #[must_use]
+    pub fn x(&self) -> &[f64] {
+        &self.x
+    }
+
+    /// Return the unique factorization scales of the grid's interpolation nodes.
+    #[must_use]
+    pub fn muf2(&self) -> &[f64] {
+        &self.muf2
+    }
+
+    /// Return the unique renormalization scales of the grid's interpolation nodes.
+    #[must_use]
+    pub fn mur2(&self) -> &[f64] {
+        &self.mur2
+    }
+
+    /// Return the PDF values as a mutable slice that the caller must fill before the convolution.
+    /// The value for the parton `pids()[ipid]` at `x()[ix]` and `muf2()[imuf2]` — multiplied with
+    /// `x`, as usual — is stored at the index `(ipid * muf2().len() + imuf2) * x().len() + ix`.
+    pub fn values_mut(&mut self) -> &mut [f64] {
+        &mut self.values
+    }
+
+    /// Return the strong-coupling values as a mutable slice that the caller must fill before the
+    /// convolution; the entry at index `imur2` corresponds to the scale `mur2()[imur2]`.
+    pub fn alphas_mut(&mut self) -> &mut [f64] {
+        &mut self.alphas
+    }
+
+    fn pid_index(&self, pid: i32) -> usize {
+        self.pids
+            .iter()
+            .position(|&candidate| candidate == pid)
+            .unwrap_or_else(|| unreachable!())
+    }
+
+    fn node_index(nodes: &[f64], value: f64) -> usize {
+        nodes
+            .binary_search_by(|node| node.partial_cmp(&value).unwrap_or_else(|| unreachable!()))
+            .unwrap_or_else(|_| panic!("node not found in table; the grid has been modified"))
+    }
+}
+
+/// A precompiled convolution plan created by [`Grid::convolve_plan`]. The plan captures the
+/// subgrid traversal order after order/channel masking together with the channels translated to
+/// the PDG basis, so that repeated convolutions of the same grid — most prominently the customary
+/// 7-point scale variation — do not redo this work for every `(xi_r, xi_f)` point. A plan is tied
+/// to the state of the grid it was compiled from and must be recompiled after the grid has been
+/// modified.
+#[derive(Clone)]
+pub struct ConvolvePlan {
+    // `(order, bin, channel)` of every subgrid that survives the masks, together with the index
+    // into the result slice that its bin contributes to
+    subgrids: Vec<(usize, usize, usize, usize)>,
+    channels: Vec<Channel>,
+    bins: usize,
+    shape: (usize, usize, usize),
+}
+
 /// Main data structure of `PineAPPL`. This structure contains a `Subgrid` for each `LumiEntry`,
 /// bin, and coupling order it was created with.
 #[derive(Clone, Deserialize, Serialize)]
@@ -221,6 +385,9 @@ pub struct Grid {
     orders: Vec<Order>,
     subgrid_params: SubgridParams,
     more_members: MoreMembers,
+    // instrumentation only, never written to or read from grid files
+    #[serde(skip)]
+    stats: GridStats,
 }
 
 impl Grid {
@@ -245,6 +412,7 @@ impl Grid {
                     .into(),
             )),
             subgrid_params,
+            stats: GridStats::default(),
         }
     }
 
@@ -285,6 +453,7 @@ impl Grid {
             bin_limits: BinLimits::new(bin_limits),
             subgrid_params,
             more_members: MoreMembers::V3(Mmv3::new(subgrid_template)),
+            stats: GridStats::default(),
         })
     }
 
@@ -343,6 +512,7 @@ impl Grid {
     ) -> Vec<f64> {
         lumi_cache.setup(self, xi).unwrap();
 
+        let evaluations = lumi_cache.evaluations();
         let bin_indices = if bin_indices.is_empty() {
             (0..self.bin_info().bins()).collect()
         } else {
@@ -381,8 +551,10 @@ impl Grid {
 
                 lumi_cache.set_grids(&mu2_grid, &x1_grid, &x2_grid, xir, xif);
 
+                let mut nodes: u64 = 0;
                 let mut value =
                     subgrid.convolve(&x1_grid, &x2_grid, &mu2_grid, &mut |ix1, ix2, imu2| {
+                        nodes += 1;
                         let x1 = x1_grid[ix1];
                         let x2 = x2_grid[ix2];
                         let mut lumi = 0.0;
@@ -399,6 +571,8 @@ impl Grid {
                         lumi
                     });
 
+                self.stats.convolve_nodes.fetch_add(nodes, Ordering::Relaxed);
+
                 if order.logxir > 0 {
                     value *= (xir * xir).ln().powi(order.logxir.try_into().unwrap());
                 }
@@ -411,6 +585,414 @@ impl Grid {
             }
         }
 
+        self.stats
+            .pdf_evaluations
+            .fetch_add(lumi_cache.evaluations() - evaluations, Ordering::Relaxed);
+
+        bins
+    }
+
+    /// Extract the interpolation nodes of this `Grid` into a [`PdfNodeTable`]. The caller must
+    /// fill the PDF values and the strong-coupling values of the table before passing it to
+    /// [`Grid::convolve_with_table`]. The node lists correspond to the central scales; the table
+    /// path does not support scale variations.
+    #[must_use]
+    pub fn pdf_node_table(&self) -> PdfNodeTable {
+        let mut x: Vec<f64> = self
+            .subgrids
+            .iter()
+            .filter(|subgrid| !subgrid.is_empty())
+            .flat_map(|subgrid| {
+                let mut vec = subgrid.x1_grid().into_owned();
+                vec.extend_from_slice(&subgrid.x2_grid());
+                vec
+            })
+            .collect();
+        x.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+        x.dedup();
+
+        let mut muf2: Vec<f64> = self
+            .subgrids
+            .iter()
+            .filter(|subgrid| !subgrid.is_empty())
+            .flat_map(|subgrid| subgrid.mu2_grid().into_owned())
+            .map(|Mu2 { fac, .. }| fac)
+            .collect();
+        muf2.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+        muf2.dedup();
+
+        let mut mur2: Vec<f64> = self
+            .subgrids
+            .iter()
+            .filter(|subgrid| !subgrid.is_empty())
+            .flat_map(|subgrid| subgrid.mu2_grid().into_owned())
+            .map(|Mu2 { ren, .. }| ren)
+            .collect();
+        mur2.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+        mur2.dedup();
+
+        let mut pids: Vec<i32> = self
+            .pdg_channels()
+            .iter()
+            .flat_map(|channel| {
+                channel
+                    .entry()
+                    .iter()
+                    .flat_map(|&(a, b, _)| [a, b])
+                    .collect::<Vec<_>>()
+            })
+            .collect();
+        pids.sort_unstable();
+        pids.dedup();
+
+        PdfNodeTable {
+            values: vec![0.0; pids.len() * muf2.len() * x.len()],
+            alphas: vec![0.0; mur2.len()],
+            pids,
+            x,
+            muf2,
+            mur2,
+        }
+    }
+
+    /// Perform a convolution using the PDF and strong-coupling values stored in `table` instead
+    /// of callbacks; the luminosity becomes a pure lookup-and-multiply over the dense table. The
+    /// parameters `order_mask`, `bin_indices` and `channel_mask` have the same meaning as in
+    /// [`Grid::convolve`]. Only the central scales are evaluated, so orders with scale logarithms
+    /// do not contribute.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `table` was not built from the current state of this grid.
+    pub fn convolve_with_table(
+        &self,
+        table: &PdfNodeTable,
+        order_mask: &[bool],
+        bin_indices: &[usize],
+        channel_mask: &[bool],
+    ) -> Vec<f64> {
+        let bin_indices = if bin_indices.is_empty() {
+            (0..self.bin_info().bins()).collect()
+        } else {
+            bin_indices.to_vec()
+        };
+        let mut bins = vec![0.0; bin_indices.len()];
+        let normalizations = self.bin_info().normalizations();
+        let pdg_channels = self.pdg_channels();
+        let nx = table.x.len();
+
+        for ((ord, bin, chan), subgrid) in self.subgrids.indexed_iter() {
+            let order = &self.orders[ord];
+
+            // without scale variation the scale-log orders do not contribute
+            if (order.logxir > 0) || (order.logxif > 0) {
+                continue;
+            }
+
+            if (!order_mask.is_empty() && !order_mask[ord])
+                || (!channel_mask.is_empty() && !channel_mask[chan])
+            {
+                continue;
+            }
+
+            let Some(bin_index) = bin_indices.iter().position(|&index| index == bin) else {
+                continue;
+            };
+
+            if subgrid.is_empty() {
+                continue;
+            }
+
+            let channel = &pdg_channels[chan];
+            let mu2_grid = subgrid.mu2_grid();
+            let x1_grid = subgrid.x1_grid();
+            let x2_grid = subgrid.x2_grid();
+
+            // translate the subgrid nodes into table indices once per subgrid
+            let x1_index: Vec<usize> = x1_grid
+                .iter()
+                .map(|&x| PdfNodeTable::node_index(&table.x, x))
+                .collect();
+            let x2_index: Vec<usize> = x2_grid
+                .iter()
+                .map(|&x| PdfNodeTable::node_index(&table.x, x))
+                .collect();
+            let muf2_index: Vec<usize> = mu2_grid
+                .iter()
+                .map(|mu2| PdfNodeTable::node_index(&table.muf2, mu2.fac))
+                .collect();
+            let alphas_pow: Vec<f64> = mu2_grid
+                .iter()
+                .map(|mu2| {
+                    table.alphas[PdfNodeTable::node_index(&table.mur2, mu2.ren)]
+                        .powi(order.alphas.try_into().unwrap())
+                })
+                .collect();
+            let rows: Vec<(usize, usize, f64)> = channel
+                .entry()
+                .iter()
+                .map(|&(a, b, factor)| {
+                    (
+                        table.pid_index(a) * table.muf2.len(),
+                        table.pid_index(b) * table.muf2.len(),
+                        factor,
+                    )
+                })
+                .collect();
+
+            let mut nodes: u64 = 0;
+            let value = subgrid.convolve(&x1_grid, &x2_grid, &mu2_grid, &mut |i1, i2, imu2| {
+                nodes += 1;
+                let muf2_offset = muf2_index[imu2];
+                let mut lumi = 0.0;
+
+                for &(row1, row2, factor) in &rows {
+                    let xfx1 = table.values[(row1 + muf2_offset) * nx + x1_index[i1]];
+                    let xfx2 = table.values[(row2 + muf2_offset) * nx + x2_index[i2]];
+                    lumi += xfx1 * xfx2 * factor;
+                }
+
+                lumi / (x1_grid[i1] * x2_grid[i2]) * alphas_pow[imu2]
+            });
+
+            self.stats.convolve_nodes.fetch_add(nodes, Ordering::Relaxed);
+
+            bins[bin_index] += value / normalizations[bin];
+        }
+
+        bins
+    }
+
+    /// Compile a convolution plan that restricts the convolution to the orders, bins and channels
+    /// corresponding to `order_mask`, `bin_indices` and `channel_mask`, which have the same
+    /// meaning as in [`Grid::convolve`]. The plan can be executed for many `(xi_r, xi_f)` points
+    /// at once with [`Grid::convolve_with_plan`].
+    #[must_use]
+    pub fn convolve_plan(
+        &self,
+        order_mask: &[bool],
+        bin_indices: &[usize],
+        channel_mask: &[bool],
+    ) -> ConvolvePlan {
+        let bin_indices = if bin_indices.is_empty() {
+            (0..self.bin_info().bins()).collect()
+        } else {
+            bin_indices.to_vec()
+        };
+
+        let subgrids = self
+            .subgrids
+            .indexed_iter()
+            .filter_map(|((ord, bin, chan), subgrid)| {
+                if (!order_mask.is_empty() && !order_mask[ord])
+                    || (!channel_mask.is_empty() && !channel_mask[chan])
+                    || subgrid.is_empty()
+                {
+                    return None;
+                }
+
+                bin_indices
+                    .iter()
+                    .position(|&index| index == bin)
+                    .map(|bin_index| (ord, bin, chan, bin_index))
+            })
+            .collect();
+
+        ConvolvePlan {
+            subgrids,
+            channels: self.pdg_channels().into_owned(),
+            bins: bin_indices.len(),
+            shape: self.subgrids.dim(),
+        }
+    }
+
+    /// Perform the convolution described by `plan` for all `(xi_r, xi_f)` points in `xi` in a
+    /// single pass over the subgrids, so that each subgrid is read only once instead of once per
+    /// point. The result is laid out like the one of [`Grid::convolve`].
+    ///
+    /// # Panics
+    ///
+    /// Panics if `plan` was compiled from a grid with different dimensions than `self`.
+    pub fn convolve_with_plan(
+        &self,
+        plan: &ConvolvePlan,
+        lumi_cache: &mut LumiCache,
+        xi: &[(f64, f64)],
+    ) -> Vec<f64> {
+        assert_eq!(plan.shape, self.subgrids.dim());
+
+        lumi_cache.setup(self, xi).unwrap();
+
+        let evaluations = lumi_cache.evaluations();
+        let mut bins = vec![0.0; plan.bins * xi.len()];
+        let normalizations = self.bin_info().normalizations();
+
+        for &(ord, bin, chan, bin_index) in &plan.subgrids {
+            let subgrid = &self.subgrids[[ord, bin, chan]];
+            let order = &self.orders[ord];
+            let channel = &plan.channels[chan];
+
+            // these grids are shared by all `(xi_r, xi_f)` points
+            let mu2_grid = subgrid.mu2_grid();
+            let x1_grid = subgrid.x1_grid();
+            let x2_grid = subgrid.x2_grid();
+
+            for (xi_index, &(xir, xif)) in xi.iter().enumerate() {
+                if ((order.logxir > 0) && (xir == 1.0)) || ((order.logxif > 0) && (xif == 1.0)) {
+                    continue;
+                }
+
+                lumi_cache.set_grids(&mu2_grid, &x1_grid, &x2_grid, xir, xif);
+
+                let mut nodes: u64 = 0;
+                let mut value =
+                    subgrid.convolve(&x1_grid, &x2_grid, &mu2_grid, &mut |ix1, ix2, imu2| {
+                        nodes += 1;
+                        let x1 = x1_grid[ix1];
+                        let x2 = x2_grid[ix2];
+                        let mut lumi = 0.0;
+
+                        for entry in channel.entry() {
+                            let xfx1 = lumi_cache.xfx1(entry.0, ix1, imu2);
+                            let xfx2 = lumi_cache.xfx2(entry.1, ix2, imu2);
+                            lumi += xfx1 * xfx2 * entry.2 / (x1 * x2);
+                        }
+
+                        let alphas = lumi_cache.alphas(imu2);
+
+                        lumi *= alphas.powi(order.alphas.try_into().unwrap());
+                        lumi
+                    });
+
+                self.stats.convolve_nodes.fetch_add(nodes, Ordering::Relaxed);
+
+                if order.logxir > 0 {
+                    value *= (xir * xir).ln().powi(order.logxir.try_into().unwrap());
+                }
+
+                if order.logxif > 0 {
+                    value *= (xif * xif).ln().powi(order.logxif.try_into().unwrap());
+                }
+
+                bins[xi_index + xi.len() * bin_index] += value / normalizations[bin];
+            }
+        }
+
+        self.stats
+            .pdf_evaluations
+            .fetch_add(lumi_cache.evaluations() - evaluations, Ordering::Relaxed);
+
+        bins
+    }
+
+    /// Perform convolutions with several PDFs — for instance all members of a PDF set — in a
+    /// single pass over the grid. Each element of `lumi_caches` corresponds to one PDF, and for
+    /// every subgrid the mask checks, bin lookup, and channel resolution are shared by all of
+    /// them. The remaining parameters have the same meaning as in [`Grid::convolve`]. The results
+    /// are returned member-by-member: the first `bin_indices.len() * xi.len()` elements contain
+    /// the predictions of the first member, and so on.
+    ///
+    /// # Panics
+    ///
+    /// TODO
+    pub fn convolve_multi(
+        &self,
+        lumi_caches: &mut [LumiCache],
+        order_mask: &[bool],
+        bin_indices: &[usize],
+        channel_mask: &[bool],
+        xi: &[(f64, f64)],
+    ) -> Vec<f64> {
+        for lumi_cache in lumi_caches.iter_mut() {
+            lumi_cache.setup(self, xi).unwrap();
+        }
+
+        let evaluations: u64 = lumi_caches.iter().map(|cache| cache.evaluations()).sum();
+        let bin_indices = if bin_indices.is_empty() {
+            (0..self.bin_info().bins()).collect()
+        } else {
+            bin_indices.to_vec()
+        };
+        let results_per_member = bin_indices.len() * xi.len();
+        let mut bins = vec![0.0; lumi_caches.len() * results_per_member];
+        let normalizations = self.bin_info().normalizations();
+        let pdg_channels = self.pdg_channels();
+
+        for (xi_index, &(xir, xif)) in xi.iter().enumerate() {
+            for ((ord, bin, chan), subgrid) in self.subgrids.indexed_iter() {
+                let order = &self.orders[ord];
+
+                if ((order.logxir > 0) && (xir == 1.0)) || ((order.logxif > 0) && (xif == 1.0)) {
+                    continue;
+                }
+
+                if (!order_mask.is_empty() && !order_mask[ord])
+                    || (!channel_mask.is_empty() && !channel_mask[chan])
+                {
+                    continue;
+                }
+
+                let Some(bin_index) = bin_indices.iter().position(|&index| index == bin) else {
+                    continue;
+                };
+
+                if subgrid.is_empty() {
+                    continue;
+                }
+
+                let channel = &pdg_channels[chan];
+                let mu2_grid = subgrid.mu2_grid();
+                let x1_grid = subgrid.x1_grid();
+                let x2_grid = subgrid.x2_grid();
+
+                for (member, lumi_cache) in lumi_caches.iter_mut().enumerate() {
+                    lumi_cache.set_grids(&mu2_grid, &x1_grid, &x2_grid, xir, xif);
+
+                    let mut nodes: u64 = 0;
+                    let mut value =
+                        subgrid.convolve(&x1_grid, &x2_grid, &mu2_grid, &mut |ix1, ix2, imu2| {
+                            nodes += 1;
+                            let x1 = x1_grid[ix1];
+                            let x2 = x2_grid[ix2];
+                            let mut lumi = 0.0;
+
+                            for entry in channel.entry() {
+                                let xfx1 = lumi_cache.xfx1(entry.0, ix1, imu2);
+                                let xfx2 = lumi_cache.xfx2(entry.1, ix2, imu2);
+                                lumi += xfx1 * xfx2 * entry.2 / (x1 * x2);
+                            }
+
+                            let alphas = lumi_cache.alphas(imu2);
+
+                            lumi *= alphas.powi(order.alphas.try_into().unwrap());
+                            lumi
+                        });
+
+                    self.stats.convolve_nodes.fetch_add(nodes, Ordering::Relaxed);
+
+                    if order.logxir > 0 {
+                        value *= (xir * xir).ln().powi(order.logxir.try_into().unwrap());
+                    }
+
+                    if order.logxif > 0 {
+                        value *= (xif * xif).ln().powi(order.logxif.try_into().unwrap());
+                    }
+
+                    bins[member * results_per_member + xi_index + xi.len() * bin_index] +=
+                        value / normalizations[bin];
+                }
+            }
+        }
+
+        self.stats.pdf_evaluations.fetch_add(
+            lumi_caches
+                .iter()
+                .map(|cache| cache.evaluations())
+                .sum::<u64>()
+                - evaluations,
+            Ordering::Relaxed,
+        );
+
         bins
     }
 
@@ -484,17 +1066,158 @@ impl Grid {
     ///
     /// TODO
     pub fn fill(&mut self, order: usize, observable: f64, channel: usize, ntuple: &Ntuple<f64>) {
+        self.stats.fill_calls.fetch_add(1, Ordering::Relaxed);
+
         if let Some(bin) = self.bin_limits.index(observable) {
+            let subgrid = &mut self.subgrids[[order, bin, channel]];
+            match subgrid {
+                SubgridEnum::EmptySubgridV1(_) => {
+                    if let MoreMembers::V3(mmv3) = &self.more_members {
+                        *subgrid = mmv3.subgrid_template.clone_empty();
+                        self.stats.subgrid_allocations.fetch_add(1, Ordering::Relaxed);
+                    } else {
+                        unreachable!();
+                    }
+
+                    subgrid.fill(ntuple);
+                }
+                SubgridEnum::ImportOnlySubgridV2(_) => {
+                    // the subgrid was compacted by `Grid::compact_subgrids` while the grid is
+                    // still being filled; fill the event into a fresh subgrid and merge it, which
+                    // is correct but slow — this is why only cold subgrids should be compacted
+                    if let MoreMembers::V3(mmv3) = &self.more_members {
+                        let mut fresh = mmv3.subgrid_template.clone_empty();
+                        fresh.fill(ntuple);
+                        subgrid.merge(&mut ImportOnlySubgridV2::from(&fresh).into(), false);
+                    } else {
+                        unreachable!();
+                    }
+                }
+                _ => subgrid.fill(ntuple),
+            }
+        } else {
+            self.stats.bin_search_misses.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Returns the index of the bin that the value `observable` falls into, or `None` if it over-
+    /// or underflows the bin limits this grid was created with.
+    #[must_use]
+    pub fn bin_index(&self, observable: f64) -> Option<usize> {
+        self.bin_limits.index(observable)
+    }
+
+    /// Returns the instrumentation counters of this `Grid`, which are updated by the fill and
+    /// convolution methods.
+    #[must_use]
+    pub const fn stats(&self) -> &GridStats {
+        &self.stats
+    }
+
+    /// Compacts all non-empty subgrids for which `cold` returns `true` by replacing them with
+    /// [`ImportOnlySubgridV2`]s, which only store the non-zero entries. In contrast to
+    /// [`Grid::optimize`] this method may be called while the grid is still being filled, which
+    /// keeps the resident size of a long fill run close to the optimized footprint: events that
+    /// hit a compacted subgrid are merged into it by [`Grid::fill`]. Since this merge is much
+    /// slower than a regular fill, `cold` should only select subgrids that are unlikely to be
+    /// filled again soon.
+    pub fn compact_subgrids(&mut self, mut cold: impl FnMut(usize, usize, usize) -> bool) {
+        for ((order, bin, channel), subgrid) in self.subgrids.indexed_iter_mut() {
+            match subgrid {
+                // replace empty subgrids of any type with `EmptySubgridV1`
+                _ if subgrid.is_empty() => {
+                    *subgrid = EmptySubgridV1.into();
+                }
+                // already compact or can't be compacted without losing information
+                SubgridEnum::EmptySubgridV1(_)
+                | SubgridEnum::NtupleSubgridV1(_)
+                | SubgridEnum::ImportOnlySubgridV1(_)
+                | SubgridEnum::ImportOnlySubgridV2(_) => {}
+                _ => {
+                    if cold(order, bin, channel) {
+                        let mut new_subgrid = ImportOnlySubgridV2::from(&*subgrid).into();
+                        mem::swap(subgrid, &mut new_subgrid);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Validates `order` and `channel` and prepares the corresponding subgrids for repeated
+    /// filling with [`Grid::fill_unchecked`]: every empty subgrid of the given order and channel
+    /// is replaced by an empty clone of the subgrid template, so that the per-event empty-subgrid
+    /// check of [`Grid::fill`] can be skipped.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `order` or `channel` are out of range.
+    pub fn prepare_fill(&mut self, order: usize, channel: usize) {
+        assert!(order < self.orders.len());
+        assert!(channel < self.channels.len());
+
+        for bin in 0..self.bin_limits.bins() {
             let subgrid = &mut self.subgrids[[order, bin, channel]];
             if let SubgridEnum::EmptySubgridV1(_) = subgrid {
                 if let MoreMembers::V3(mmv3) = &self.more_members {
                     *subgrid = mmv3.subgrid_template.clone_empty();
+                    self.stats.subgrid_allocations.fetch_add(1, Ordering::Relaxed);
                 } else {
                     unreachable!();
                 }
             }
+        }
+    }
 
-            subgrid.fill(ntuple);
+    /// Fills the grid like [`Grid::fill`], but without the per-event empty-subgrid check; the
+    /// subgrids for `order` and `channel` must have been prepared with [`Grid::prepare_fill`]
+    /// before. Subgrids touched by [`Grid::compact_subgrids`] after the preparation are handled
+    /// like in [`Grid::fill`]: compacted ones are filled through the merge path and ones that
+    /// were reset to empty are instantiated from the subgrid template again.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `order` or `channel` are out of range.
+    pub fn fill_unchecked(
+        &mut self,
+        order: usize,
+        channel: usize,
+        observable: f64,
+        ntuple: &Ntuple<f64>,
+    ) {
+        self.stats.fill_calls.fetch_add(1, Ordering::Relaxed);
+
+        if let Some(bin) = self.bin_limits.index(observable) {
+            let subgrid = &mut self.subgrids[[order, bin, channel]];
+            match subgrid {
+                SubgridEnum::EmptySubgridV1(_) => {
+                    // `Grid::compact_subgrids` reset this still-empty subgrid after
+                    // `prepare_fill`; instantiate the template again, as `Grid::fill` does
+                    if let MoreMembers::V3(mmv3) = &self.more_members {
+                        *subgrid = mmv3.subgrid_template.clone_empty();
+                        self.stats
+                            .subgrid_allocations
+                            .fetch_add(1, Ordering::Relaxed);
+                    } else {
+                        unreachable!();
+                    }
+
+                    subgrid.fill(ntuple);
+                }
+                SubgridEnum::ImportOnlySubgridV2(_) => {
+                    // the subgrid was compacted by `Grid::compact_subgrids` after `prepare_fill`;
+                    // fill the event into a fresh subgrid and merge it, as `Grid::fill` does
+                    if let MoreMembers::V3(mmv3) = &self.more_members {
+                        let mut fresh = mmv3.subgrid_template.clone_empty();
+                        fresh.fill(ntuple);
+                        subgrid.merge(&mut ImportOnlySubgridV2::from(&fresh).into(), false);
+                    } else {
+                        unreachable!();
+                    }
+                }
+                _ => subgrid.fill(ntuple),
+            }
+        } else {
+            self.stats.bin_search_misses.fetch_add(1, Ordering::Relaxed);
         }
     }
 
@@ -548,6 +1271,11 @@ impl Grid {
     /// If writing fails an error is returned.
     pub fn write(&self, writer: impl Write) -> Result<(), GridError> {
         let mut writer = BufWriter::new(writer);
+        self.write_payload(&mut writer)?;
+        self.write_footer(&mut writer)
+    }
+
+    fn write_payload(&self, mut writer: impl Write) -> Result<(), GridError> {
         let file_header = b"PineAPPL\0\0\0\0\0\0\0\0";
 
         // first write PineAPPL file header
@@ -557,6 +1285,61 @@ impl Grid {
         bincode::serialize_into(writer, self).map_err(GridError::WriteFailure)
     }
 
+    fn write_footer(&self, mut writer: impl Write) -> Result<(), GridError> {
+        let footer = GridFooter {
+            channels: self.channels.clone(),
+            bin_limits: self.bin_limits.clone(),
+            orders: self.orders.clone(),
+            key_values: self.key_values().cloned(),
+        };
+        let buffer = bincode::serialize(&footer).map_err(GridError::WriteFailure)?;
+
+        // readers that deserialize the grid itself stop before the footer and are not affected by
+        // its presence; readers that only need the metadata seek to the end of the file instead,
+        // check the magic bytes and read the footer without touching the subgrid data
+        writer.write_all(&buffer).map_err(GridError::IoFailure)?;
+        writer
+            .write_all(&u64::try_from(buffer.len()).unwrap().to_le_bytes())
+            .map_err(GridError::IoFailure)?;
+        writer.write_all(&FOOTER_MAGIC).map_err(GridError::IoFailure)
+    }
+
+    /// Reads the metadata footer from `reader`. This only requires two seeks and reads whose sizes
+    /// are independent of the number of subgrids, so it is much cheaper than deserializing the
+    /// grid with [`Grid::read`] when only the metadata is needed.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`GridError::FooterMissing`] if the file was written by a version of `PineAPPL`
+    /// that did not yet append a metadata footer; an error is also returned when reading fails.
+    pub fn read_footer(mut reader: impl Read + Seek) -> Result<GridFooter, GridError> {
+        let mut trailer = [0; 24];
+
+        reader
+            .seek(SeekFrom::End(-24))
+            .map_err(GridError::IoFailure)?;
+        reader
+            .read_exact(&mut trailer)
+            .map_err(GridError::IoFailure)?;
+
+        if trailer[8..24] != FOOTER_MAGIC {
+            return Err(GridError::FooterMissing);
+        }
+
+        let length = u64::from_le_bytes(trailer[0..8].try_into().unwrap_or_else(|_| unreachable!()));
+
+        reader
+            .seek(SeekFrom::End(-24 - i64::try_from(length).unwrap()))
+            .map_err(GridError::IoFailure)?;
+
+        let mut buffer = vec![0; usize::try_from(length).unwrap()];
+        reader
+            .read_exact(&mut buffer)
+            .map_err(GridError::IoFailure)?;
+
+        bincode::deserialize(&buffer).map_err(GridError::ReadFailure)
+    }
+
     /// Serializes `self` into `writer`, using LZ4 compression. Writing is buffered.
     ///
     /// # Errors
@@ -566,13 +1349,15 @@ impl Grid {
     /// # Panics
     ///
     /// TODO
-    pub fn write_lz4(&self, writer: impl Write) -> Result<(), GridError> {
-        let mut encoder = FrameEncoder::new(writer);
-        self.write(&mut encoder)?;
+    pub fn write_lz4(&self, mut writer: impl Write) -> Result<(), GridError> {
+        let mut encoder = FrameEncoder::new(&mut writer);
+        self.write_payload(&mut encoder)?;
         // TODO: get rid of the unwrap call and return the error
         encoder.try_finish().unwrap();
 
-        Ok(())
+        // the footer is appended after the compressed frame, so that it can be found with a seek
+        // without decompressing the payload
+        self.write_footer(writer)
     }
 
     /// Fills the grid with events for the parton momentum fractions `x1` and `x2`, the scale `q2`,
@@ -1007,10 +1792,10 @@ impl Grid {
         BinInfo::new(&self.bin_limits, self.remapper())
     }
 
-    /// Calls [`Self::optimize_using`] with all possible optimization options
-    /// ([`GridOptFlags::all`]).
+    /// Calls [`Self::optimize_using`] with all lossless optimization options.
     pub fn optimize(&mut self) {
-        self.optimize_using(GridOptFlags::all());
+        // `USE_SINGLE_PRECISION` rounds the subgrid weights and must be requested explicitly
+        self.optimize_using(GridOptFlags::all() - GridOptFlags::USE_SINGLE_PRECISION);
     }
 
     /// Optimizes the internal datastructures for space efficiency. The parameter `flags`
@@ -1032,6 +1817,9 @@ impl Grid {
         if flags.contains(GridOptFlags::STRIP_EMPTY_CHANNELS) {
             self.strip_empty_channels();
         }
+        if flags.contains(GridOptFlags::USE_SINGLE_PRECISION) {
+            self.convert_to_single_precision();
+        }
     }
 
     fn optimize_subgrid_type(&mut self, static_scale_detection: bool) {
@@ -1060,6 +1848,20 @@ impl Grid {
         }
     }
 
+    fn convert_to_single_precision(&mut self) {
+        for subgrid in &mut self.subgrids {
+            match subgrid {
+                SubgridEnum::EmptySubgridV1(_) | SubgridEnum::SinglePrecisionSubgridV1(_) => {}
+                // can't be converted without losing the ntuples
+                SubgridEnum::NtupleSubgridV1(_) => {}
+                _ => {
+                    let mut new_subgrid = SinglePrecisionSubgridV1::from(&*subgrid).into();
+                    mem::swap(subgrid, &mut new_subgrid);
+                }
+            }
+        }
+    }
+
     /// Try to deduplicate channels by detecting pairs of them that contain the same subgrids. The
     /// numerical equality is tested using a tolerance of `ulps`, given in [units of least
     /// precision](https://docs.rs/float-cmp/latest/float_cmp/index.html#some-explanation).
@@ -1448,6 +2250,7 @@ impl Grid {
                 orders: vec![Order::new(0, 0, 0, 0)],
                 subgrid_params: SubgridParams::default(),
                 more_members: self.more_members.clone(),
+                stats: GridStats::default(),
             };
 
             // TODO: use a new constructor to set this information
@@ -1679,6 +2482,7 @@ mod tests {
     use crate::channel;
     use float_cmp::assert_approx_eq;
     use std::fs::File;
+    use std::io::Cursor;
 
     #[test]
     fn grid_with_subgrid_type() {
@@ -1978,4 +2782,382 @@ mod tests {
         assert_eq!(info.ren1.len(), 1);
         assert_approx_eq!(f64, info.ren1[0], 6456.443904000001, ulps = 64);
     }
+
+    #[test]
+    fn grid_compact_subgrids() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        let ntuple = Ntuple {
+            x1: 0.25,
+            x2: 0.5,
+            q2: 10000.0,
+            weight: 1.0,
+        };
+        grid.fill(0, 0.25, 0, &ntuple);
+
+        let sum = |grid: &Grid| -> f64 {
+            grid.subgrids
+                .iter()
+                .flat_map(|subgrid| subgrid.indexed_iter().map(|(_, value)| value))
+                .sum()
+        };
+        let reference = sum(&grid);
+
+        grid.compact_subgrids(|_, _, _| true);
+
+        assert!(matches!(
+            grid.subgrids[[0, 0, 0]],
+            SubgridEnum::ImportOnlySubgridV2(_)
+        ));
+        assert_approx_eq!(f64, sum(&grid), reference, ulps = 8);
+
+        // filling a compacted subgrid must merge the event into it
+        grid.fill(0, 0.25, 0, &ntuple);
+
+        assert!(matches!(
+            grid.subgrids[[0, 0, 0]],
+            SubgridEnum::ImportOnlySubgridV2(_)
+        ));
+        assert_approx_eq!(f64, sum(&grid), 2.0 * reference, ulps = 8);
+    }
+
+    #[test]
+    fn grid_fill_unchecked_compacted_subgrid() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        let ntuple = Ntuple {
+            x1: 0.25,
+            x2: 0.5,
+            q2: 10000.0,
+            weight: 1.0,
+        };
+        grid.prepare_fill(0, 0);
+        grid.fill_unchecked(0, 0, 0.25, &ntuple);
+
+        let sum = |grid: &Grid| -> f64 {
+            grid.subgrids
+                .iter()
+                .flat_map(|subgrid| subgrid.indexed_iter().map(|(_, value)| value))
+                .sum()
+        };
+        let reference = sum(&grid);
+
+        // compacting a subgrid after `prepare_fill` must not break the prepared fill loop
+        grid.compact_subgrids(|_, _, _| true);
+        grid.fill_unchecked(0, 0, 0.25, &ntuple);
+
+        assert!(matches!(
+            grid.subgrids[[0, 0, 0]],
+            SubgridEnum::ImportOnlySubgridV2(_)
+        ));
+        assert_approx_eq!(f64, sum(&grid), 2.0 * reference, ulps = 8);
+
+        // the compaction also reset the prepared but still empty subgrid of the second bin;
+        // filling it must instantiate the template again instead of panicking
+        assert!(matches!(
+            grid.subgrids[[0, 1, 0]],
+            SubgridEnum::EmptySubgridV1(_)
+        ));
+        grid.fill_unchecked(0, 0, 0.75, &ntuple);
+
+        assert!(!grid.subgrids[[0, 1, 0]].is_empty());
+        assert_approx_eq!(f64, sum(&grid), 3.0 * reference, ulps = 8);
+    }
+
+    #[test]
+    fn grid_optimize_single_precision() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        grid.fill(
+            0,
+            0.25,
+            0,
+            &Ntuple {
+                x1: 0.25,
+                x2: 0.5,
+                q2: 10000.0,
+                weight: 1.0,
+            },
+        );
+
+        let convolve = |grid: &Grid| -> Vec<f64> {
+            let mut xfx = |_, x: f64, _| x;
+            let mut alphas = |_| 1.0;
+            let mut lumi_cache = LumiCache::with_one(2212, &mut xfx, &mut alphas);
+            grid.convolve(&mut lumi_cache, &[], &[], &[], &[(1.0, 1.0)])
+        };
+        let reference = convolve(&grid);
+
+        // the default optimization is lossless and must not round the weights
+        grid.optimize();
+
+        assert!(matches!(
+            grid.subgrids[[0, 0, 0]],
+            SubgridEnum::ImportOnlySubgridV2(_)
+        ));
+        assert_eq!(grid.subgrids[[0, 0, 0]].stats().bytes_per_value, 8);
+
+        grid.optimize_using(GridOptFlags::USE_SINGLE_PRECISION);
+
+        assert!(matches!(
+            grid.subgrids[[0, 0, 0]],
+            SubgridEnum::SinglePrecisionSubgridV1(_)
+        ));
+        assert_eq!(grid.subgrids[[0, 0, 0]].stats().bytes_per_value, 4);
+
+        // each weight is rounded once, so the results agree to single precision; the second bin
+        // was never filled and must stay exactly zero
+        for (result, reference) in convolve(&grid).iter().zip(&reference) {
+            if *reference == 0.0 {
+                assert_eq!(*result, 0.0);
+            } else {
+                assert!((result / reference - 1.0).abs() < 1e-6);
+            }
+        }
+
+        // the conversion must survive a write-read roundtrip
+        let mut buffer = Cursor::new(Vec::new());
+        grid.write(&mut buffer).unwrap();
+        buffer.set_position(0);
+        let roundtrip = Grid::read(&mut buffer).unwrap();
+
+        assert!(matches!(
+            roundtrip.subgrids[[0, 0, 0]],
+            SubgridEnum::SinglePrecisionSubgridV1(_)
+        ));
+    }
+
+    #[test]
+    fn grid_stats() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        assert_eq!(grid.stats().fill_calls(), 0);
+
+        let ntuple = Ntuple {
+            x1: 0.25,
+            x2: 0.5,
+            q2: 10000.0,
+            weight: 1.0,
+        };
+        grid.fill(0, 0.25, 0, &ntuple);
+        grid.fill(0, 0.75, 0, &ntuple);
+        // this observable overflows the bin limits
+        grid.fill(0, 1.5, 0, &ntuple);
+
+        let stats = grid.stats();
+        assert_eq!(stats.fill_calls(), 3);
+        assert_eq!(stats.bin_search_misses(), 1);
+        assert_eq!(stats.subgrid_allocations(), 2);
+
+        // counters survive cloning, but are not serialized
+        assert_eq!(grid.clone().stats().fill_calls(), 3);
+
+        let mut buffer = Cursor::new(Vec::new());
+        grid.write(&mut buffer).unwrap();
+        buffer.set_position(0);
+        let roundtrip = Grid::read(&mut buffer).unwrap();
+
+        assert_eq!(roundtrip.stats().fill_calls(), 0);
+
+        let mut xfx = |_, x: f64, _| x;
+        let mut alphas = |_| 1.0;
+        let mut lumi_cache = LumiCache::with_one(2212, &mut xfx, &mut alphas);
+        grid.convolve(&mut lumi_cache, &[], &[], &[], &[(1.0, 1.0)]);
+
+        let stats = grid.stats();
+        assert_ne!(stats.pdf_evaluations(), 0);
+        assert_ne!(stats.convolve_nodes(), 0);
+    }
+
+    #[test]
+    fn grid_convolve_with_plan() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        grid.fill(
+            0,
+            0.25,
+            0,
+            &Ntuple {
+                x1: 0.25,
+                x2: 0.5,
+                q2: 10000.0,
+                weight: 1.0,
+            },
+        );
+        grid.fill(
+            0,
+            0.75,
+            0,
+            &Ntuple {
+                x1: 0.125,
+                x2: 0.625,
+                q2: 20000.0,
+                weight: 2.0,
+            },
+        );
+
+        let xi = [(1.0, 1.0), (2.0, 2.0), (0.5, 0.5)];
+
+        let mut xfx = |_, x: f64, _| x;
+        let mut alphas = |_| 1.0;
+        let mut lumi_cache = LumiCache::with_one(2212, &mut xfx, &mut alphas);
+        let reference = grid.convolve(&mut lumi_cache, &[], &[], &[], &xi);
+
+        let plan = grid.convolve_plan(&[], &[], &[]);
+        let results = grid.convolve_with_plan(&plan, &mut lumi_cache, &xi);
+
+        assert_eq!(results.len(), reference.len());
+
+        for (result, reference) in results.iter().zip(&reference) {
+            assert_approx_eq!(f64, *result, *reference, ulps = 8);
+        }
+    }
+
+    #[test]
+    fn grid_convolve_with_table() {
+        let mut grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.5, 1.0],
+            SubgridParams::default(),
+        );
+
+        grid.fill(
+            0,
+            0.25,
+            0,
+            &Ntuple {
+                x1: 0.25,
+                x2: 0.5,
+                q2: 10000.0,
+                weight: 1.0,
+            },
+        );
+        grid.fill(
+            0,
+            0.75,
+            0,
+            &Ntuple {
+                x1: 0.125,
+                x2: 0.625,
+                q2: 20000.0,
+                weight: 2.0,
+            },
+        );
+
+        // reference result with the callback-based convolution and the PDF `xfx(x) = x`
+        let mut xfx = |_, x: f64, _| x;
+        let mut alphas = |_| 1.0;
+        let mut lumi_cache = LumiCache::with_one(2212, &mut xfx, &mut alphas);
+        let reference = grid.convolve(&mut lumi_cache, &[], &[], &[], &[(1.0, 1.0)]);
+
+        let mut table = grid.pdf_node_table();
+
+        assert_eq!(table.pids(), [2, 4]);
+
+        let x_nodes = table.x().to_vec();
+        let muf2_count = table.muf2().len();
+        let pid_count = table.pids().len();
+
+        for ipid in 0..pid_count {
+            for imuf2 in 0..muf2_count {
+                for (ix, &x) in x_nodes.iter().enumerate() {
+                    table.values_mut()[(ipid * muf2_count + imuf2) * x_nodes.len() + ix] = x;
+                }
+            }
+        }
+        for alphas in table.alphas_mut() {
+            *alphas = 1.0;
+        }
+
+        let results = grid.convolve_with_table(&table, &[], &[], &[]);
+
+        assert_eq!(results.len(), reference.len());
+
+        for (result, reference) in results.iter().zip(&reference) {
+            assert_approx_eq!(f64, *result, *reference, ulps = 8);
+        }
+    }
+
+    #[test]
+    fn grid_read_footer() {
+        let mut grid = Grid::new(
+            vec![
+                channel![2, 2, 1.0; 4, 4, 1.0],
+                channel![1, 1, 1.0; 3, 3, 1.0],
+            ],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 0.25, 0.5, 0.75, 1.0],
+            SubgridParams::default(),
+        );
+        grid.set_key_value("lumi_id_types", "pdg_mc_ids");
+
+        for compress in [false, true] {
+            let mut buffer = Vec::new();
+
+            if compress {
+                grid.write_lz4(&mut buffer).unwrap();
+            } else {
+                grid.write(&mut buffer).unwrap();
+            }
+
+            // the footer must not break readers of the full grid
+            let read_back = Grid::read(&buffer[..]).unwrap();
+            assert_eq!(read_back.bin_info().bins(), 4);
+
+            let footer = Grid::read_footer(Cursor::new(&buffer)).unwrap();
+            assert_eq!(footer.bin_limits.bins(), 4);
+            assert_eq!(footer.bin_limits.limits(), [0.0, 0.25, 0.5, 0.75, 1.0]);
+            assert_eq!(footer.orders, [Order::new(0, 2, 0, 0)]);
+            assert_eq!(footer.channels.len(), 2);
+            assert_eq!(
+                footer.key_values.as_ref().unwrap()["lumi_id_types"],
+                "pdg_mc_ids"
+            );
+        }
+    }
+
+    #[test]
+    fn grid_read_footer_missing() {
+        let grid = Grid::new(
+            vec![channel![2, 2, 1.0; 4, 4, 1.0]],
+            vec![Order::new(0, 2, 0, 0)],
+            vec![0.0, 1.0],
+            SubgridParams::default(),
+        );
+
+        // files written by older versions end right after the payload
+        let mut buffer = Vec::new();
+        grid.write_payload(&mut buffer).unwrap();
+
+        assert!(matches!(
+            Grid::read_footer(Cursor::new(&buffer)),
+            Err(GridError::FooterMissing)
+        ));
+    }
 }
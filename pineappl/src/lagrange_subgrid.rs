@@ -59,6 +59,33 @@ fn fi(i: usize, n: usize, u: f64) -> f64 {
     product / f64_from_usize(factorials)
 }
 
+// unrolled variant of `fi` that computes all four weights of the default third-order
+// interpolation at once, sharing the node differences between the weights
+fn fi3(u: f64) -> [f64; 4] {
+    let w0 = u;
+    let w1 = u - 1.0;
+    let w2 = u - 2.0;
+    let w3 = u - 3.0;
+
+    [
+        -w1 * w2 * w3 / 6.0,
+        w0 * w2 * w3 / 2.0,
+        -w0 * w1 * w3 / 2.0,
+        w0 * w1 * w2 / 6.0,
+    ]
+}
+
+// compute the Lagrange weights `fi(0..=n, n, u)`; the default third-order configuration, which
+// effectively all production grids use, is dispatched to the unrolled kernel `fi3`, all other
+// orders fall back to the generic loop in `fi`
+fn fi_all(n: usize, u: f64) -> ArrayVec<f64, 8> {
+    if n == 3 {
+        fi3(u).into_iter().collect()
+    } else {
+        (0..=n).map(|i| fi(i, n, u)).collect()
+    }
+}
+
 /// Subgrid which uses Lagrange-interpolation.
 #[derive(Clone, Deserialize, Serialize)]
 pub struct LagrangeSubgridV1 {
@@ -180,12 +207,8 @@ impl Subgrid for LagrangeSubgridV1 {
         let u_y1 = (y1 - self.gety(k1)) / self.deltay();
         let u_y2 = (y2 - self.gety(k2)) / self.deltay();
 
-        let fi1: ArrayVec<_, 8> = (0..=self.yorder)
-            .map(|i| fi(i, self.yorder, u_y1))
-            .collect();
-        let fi2: ArrayVec<_, 8> = (0..=self.yorder)
-            .map(|i| fi(i, self.yorder, u_y2))
-            .collect();
+        let fi1 = fi_all(self.yorder, u_y1);
+        let fi2 = fi_all(self.yorder, u_y2);
 
         let k3 = usize_from_f64(
             (tau - self.taumin) / self.deltatau() - f64_from_usize(self.tauorder / 2),
@@ -210,9 +233,9 @@ impl Subgrid for LagrangeSubgridV1 {
             self.increase_tau(self.itaumin.min(k3), self.itaumax.max(k3 + size));
         }
 
-        for i3 in 0..=self.tauorder {
-            let fi3i3 = fi(i3, self.tauorder, u_tau);
+        let fitau = fi_all(self.tauorder, u_tau);
 
+        for (i3, fi3i3) in fitau.iter().enumerate() {
             for (i1, fi1i1) in fi1.iter().enumerate() {
                 for (i2, fi2i2) in fi2.iter().enumerate() {
                     let fillweight = factor * fi1i1 * fi2i2 * fi3i3 * ntuple.weight;
@@ -411,6 +434,9 @@ pub struct LagrangeSubgridV2 {
     taumin: f64,
     taumax: f64,
     pub(crate) static_q2: f64,
+    // only relevant while filling, hence not serialized; see `SubgridParams::allocate_upfront`
+    #[serde(skip)]
+    allocate_upfront: bool,
 }
 
 impl LagrangeSubgridV2 {
@@ -436,6 +462,7 @@ impl LagrangeSubgridV2 {
             taumin: ftau(subgrid_params.q2_min()),
             taumax: ftau(subgrid_params.q2_max()),
             static_q2: 0.0,
+            allocate_upfront: subgrid_params.allocate_upfront(),
         }
     }
 
@@ -557,12 +584,8 @@ impl Subgrid for LagrangeSubgridV2 {
         let u_y1 = (y1 - self.gety1(k1)) / self.deltay1();
         let u_y2 = (y2 - self.gety2(k2)) / self.deltay2();
 
-        let fi1: ArrayVec<_, 8> = (0..=self.y1order)
-            .map(|i| fi(i, self.y1order, u_y1))
-            .collect();
-        let fi2: ArrayVec<_, 8> = (0..=self.y2order)
-            .map(|i| fi(i, self.y2order, u_y2))
-            .collect();
+        let fi1 = fi_all(self.y1order, u_y1);
+        let fi2 = fi_all(self.y2order, u_y2);
 
         let k3 = usize_from_f64(
             (tau - self.taumin) / self.deltatau() - f64_from_usize(self.tauorder / 2),
@@ -587,22 +610,31 @@ impl Subgrid for LagrangeSubgridV2 {
         let ny2 = self.ny2;
 
         if self.grid.is_none() {
-            self.itaumin = k3;
-            self.itaumax = k3 + size;
+            if self.allocate_upfront {
+                // allocate the storage for the entire tau range in one piece, so that later
+                // events can never trigger the reallocation and copy in `increase_tau`
+                self.itaumin = 0;
+                self.itaumax = self.ntau;
+            } else {
+                self.itaumin = k3;
+                self.itaumax = k3 + size;
+            }
         } else if k3 < self.itaumin || k3 + size > self.itaumax {
             self.increase_tau(self.itaumin.min(k3), self.itaumax.max(k3 + size));
         }
 
-        for i3 in 0..=self.tauorder {
-            let fi3i3 = fi(i3, self.tauorder, u_tau);
+        let alloc_size = self.itaumax - self.itaumin;
+
+        let fitau = fi_all(self.tauorder, u_tau);
 
+        for (i3, fi3i3) in fitau.iter().enumerate() {
             for (i1, fi1i1) in fi1.iter().enumerate() {
                 for (i2, fi2i2) in fi2.iter().enumerate() {
                     let fillweight = factor * fi1i1 * fi2i2 * fi3i3 * ntuple.weight;
 
                     let grid = self
                         .grid
-                        .get_or_insert_with(|| Array3::zeros((size, ny1, ny2)));
+                        .get_or_insert_with(|| Array3::zeros((alloc_size, ny1, ny2)));
 
                     grid[[k3 + i3 - self.itaumin, k1 + i1, k2 + i2]] += fillweight;
                 }
@@ -728,6 +760,7 @@ impl Subgrid for LagrangeSubgridV2 {
             taumin: self.taumin,
             taumax: self.taumax,
             static_q2: 0.0,
+            allocate_upfront: self.allocate_upfront,
         }
         .into()
     }
@@ -889,12 +922,8 @@ impl Subgrid for LagrangeSparseSubgridV1 {
         let u_y1 = (y1 - self.gety(k1)) / self.deltay();
         let u_y2 = (y2 - self.gety(k2)) / self.deltay();
 
-        let fi1: ArrayVec<_, 8> = (0..=self.yorder)
-            .map(|i| fi(i, self.yorder, u_y1))
-            .collect();
-        let fi2: ArrayVec<_, 8> = (0..=self.yorder)
-            .map(|i| fi(i, self.yorder, u_y2))
-            .collect();
+        let fi1 = fi_all(self.yorder, u_y1);
+        let fi2 = fi_all(self.yorder, u_y2);
 
         let k3 = usize_from_f64(
             (tau - self.taumin) / self.deltatau() - f64_from_usize(self.tauorder / 2),
@@ -909,9 +938,9 @@ impl Subgrid for LagrangeSparseSubgridV1 {
             1.0
         };
 
-        for i3 in 0..=self.tauorder {
-            let fi3i3 = fi(i3, self.tauorder, u_tau);
+        let fitau = fi_all(self.tauorder, u_tau);
 
+        for (i3, fi3i3) in fitau.iter().enumerate() {
             for (i1, fi1i1) in fi1.iter().enumerate() {
                 for (i2, fi2i2) in fi2.iter().enumerate() {
                     let fillweight = factor * fi1i1 * fi2i2 * fi3i3 * ntuple.weight;
@@ -1064,6 +1093,19 @@ mod tests {
     use super::*;
     use float_cmp::assert_approx_eq;
 
+    #[test]
+    fn fi3_specialization() {
+        // the unrolled third-order kernel must reproduce the generic loop exactly
+        for step in 0..=30 {
+            let u = 0.1 * f64::from(step);
+            let weights = fi3(u);
+
+            for (i, &weight) in weights.iter().enumerate() {
+                assert_approx_eq!(f64, weight, fi(i, 3, u), ulps = 4);
+            }
+        }
+    }
+
     fn test_q2_slice_methods<G: Subgrid>(mut grid: G) -> G {
         grid.fill(&Ntuple {
             x1: 0.1,
@@ -47,5 +47,6 @@ pub mod lagrange_subgrid;
 pub mod ntuple_subgrid;
 pub mod packed_array;
 pub mod pids;
+pub mod single_precision_subgrid;
 pub mod sparse_array3;
 pub mod subgrid;
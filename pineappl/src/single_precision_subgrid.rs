@@ -0,0 +1,373 @@
+//! Provides the [`SinglePrecisionSubgridV1`] type.
+
+use super::grid::Ntuple;
+use super::import_only_subgrid::ImportOnlySubgridV2;
+use super::sparse_array3::SparseArray3;
+use super::subgrid::{Mu2, Stats, Subgrid, SubgridEnum, SubgridIndexedIter};
+use serde::{Deserialize, Serialize};
+use std::borrow::Cow;
+use std::mem;
+
+/// Import-only subgrid that stores its weights in single precision, halving the storage footprint
+/// with respect to [`ImportOnlySubgridV2`]. The weights are rounded exactly once, when the subgrid
+/// is created from a double-precision subgrid; all arithmetic performed afterwards — convolutions,
+/// merges, rescalings — accumulates in double precision.
+#[derive(Clone, Deserialize, Serialize)]
+pub struct SinglePrecisionSubgridV1 {
+    array: SparseArray3<f32>,
+    mu2_grid: Vec<Mu2>,
+    x1_grid: Vec<f64>,
+    x2_grid: Vec<f64>,
+}
+
+impl SinglePrecisionSubgridV1 {
+    /// Constructor.
+    #[must_use]
+    pub fn new(
+        array: SparseArray3<f32>,
+        mu2_grid: Vec<Mu2>,
+        x1_grid: Vec<f64>,
+        x2_grid: Vec<f64>,
+    ) -> Self {
+        Self {
+            array,
+            mu2_grid,
+            x1_grid,
+            x2_grid,
+        }
+    }
+
+    /// Return the array containing the numerical values of the grid.
+    pub fn array_mut(&mut self) -> &mut SparseArray3<f32> {
+        &mut self.array
+    }
+}
+
+impl Subgrid for SinglePrecisionSubgridV1 {
+    fn convolve(
+        &self,
+        _: &[f64],
+        _: &[f64],
+        _: &[Mu2],
+        lumi: &mut dyn FnMut(usize, usize, usize) -> f64,
+    ) -> f64 {
+        self.array
+            .indexed_iter()
+            .map(|((imu2, ix1, ix2), sigma)| f64::from(sigma) * lumi(ix1, ix2, imu2))
+            .sum()
+    }
+
+    fn fill(&mut self, _: &Ntuple<f64>) {
+        panic!("SinglePrecisionSubgridV1 doesn't support the fill operation");
+    }
+
+    fn mu2_grid(&self) -> Cow<[Mu2]> {
+        Cow::Borrowed(&self.mu2_grid)
+    }
+
+    fn x1_grid(&self) -> Cow<[f64]> {
+        Cow::Borrowed(&self.x1_grid)
+    }
+
+    fn x2_grid(&self) -> Cow<[f64]> {
+        Cow::Borrowed(&self.x2_grid)
+    }
+
+    fn is_empty(&self) -> bool {
+        self.array.is_empty()
+    }
+
+    #[allow(clippy::cast_possible_truncation)]
+    fn merge(&mut self, other: &mut SubgridEnum, transpose: bool) {
+        if let SubgridEnum::SinglePrecisionSubgridV1(other_grid) = other {
+            if self.array.is_empty() && !transpose {
+                mem::swap(&mut self.array, &mut other_grid.array);
+            } else {
+                // TODO: the general case isn't implemented
+                assert!(self.x1_grid() == other_grid.x1_grid());
+                assert!(self.x2_grid() == other_grid.x2_grid());
+
+                for (other_index, mu2) in other_grid.mu2_grid().iter().enumerate() {
+                    let index = match self
+                        .mu2_grid
+                        .binary_search_by(|val| val.partial_cmp(mu2).unwrap())
+                    {
+                        Ok(index) => index,
+                        Err(index) => {
+                            self.mu2_grid.insert(index, mu2.clone());
+                            self.array.increase_x_at(index);
+                            index
+                        }
+                    };
+
+                    for ((_, j, k), value) in other_grid
+                        .array
+                        .indexed_iter()
+                        .filter(|&((i, _, _), _)| i == other_index)
+                    {
+                        let (j, k) = if transpose { (k, j) } else { (j, k) };
+                        // sum in double precision to avoid rounding the same weight twice
+                        let entry = &mut self.array[[index, j, k]];
+                        *entry = (f64::from(*entry) + f64::from(value)) as f32;
+                    }
+                }
+            }
+        } else {
+            todo!();
+        }
+    }
+
+    #[allow(clippy::cast_possible_truncation)]
+    fn scale(&mut self, factor: f64) {
+        if factor == 0.0 {
+            self.array.clear();
+        } else {
+            self.array
+                .iter_mut()
+                .for_each(|x| *x = (f64::from(*x) * factor) as f32);
+        }
+    }
+
+    #[allow(clippy::cast_possible_truncation)]
+    fn symmetrize(&mut self) {
+        let mut new_array =
+            SparseArray3::new(self.mu2_grid.len(), self.x1_grid.len(), self.x2_grid.len());
+
+        for ((i, j, k), sigma) in self.array.indexed_iter().filter(|((_, j, k), _)| k >= j) {
+            new_array[[i, j, k]] = sigma;
+        }
+        // do not change the diagonal entries (k==j)
+        for ((i, j, k), sigma) in self.array.indexed_iter().filter(|((_, j, k), _)| k < j) {
+            let entry = &mut new_array[[i, k, j]];
+            *entry = (f64::from(*entry) + f64::from(sigma)) as f32;
+        }
+
+        mem::swap(&mut self.array, &mut new_array);
+    }
+
+    fn clone_empty(&self) -> SubgridEnum {
+        Self {
+            array: SparseArray3::new(self.mu2_grid.len(), self.x1_grid.len(), self.x2_grid.len()),
+            mu2_grid: self.mu2_grid.clone(),
+            x1_grid: self.x1_grid.clone(),
+            x2_grid: self.x2_grid.clone(),
+        }
+        .into()
+    }
+
+    fn indexed_iter(&self) -> SubgridIndexedIter {
+        Box::new(
+            self.array
+                .indexed_iter()
+                .map(|(index, value)| (index, f64::from(value))),
+        )
+    }
+
+    fn stats(&self) -> Stats {
+        Stats {
+            total: self.mu2_grid.len() * self.x1_grid.len() * self.x2_grid.len(),
+            allocated: self.array.len() + self.array.zeros(),
+            zeros: self.array.zeros(),
+            overhead: self.array.overhead(),
+            bytes_per_value: mem::size_of::<f32>(),
+        }
+    }
+
+    fn static_scale(&self) -> Option<Mu2> {
+        if let [static_scale] = self.mu2_grid.as_slice() {
+            Some(static_scale.clone())
+        } else {
+            None
+        }
+    }
+}
+
+impl From<&SubgridEnum> for SinglePrecisionSubgridV1 {
+    #[allow(clippy::cast_possible_truncation)]
+    fn from(subgrid: &SubgridEnum) -> Self {
+        // perform the range shrinking and the static-scale detection in double precision and
+        // round each weight only once, at the very end
+        let subgrid: SubgridEnum = ImportOnlySubgridV2::from(subgrid).into();
+
+        let mu2_grid = subgrid.mu2_grid().into_owned();
+        let x1_grid = subgrid.x1_grid().into_owned();
+        let x2_grid = subgrid.x2_grid().into_owned();
+
+        let mut array = SparseArray3::new(mu2_grid.len(), x1_grid.len(), x2_grid.len());
+
+        for ((imu2, ix1, ix2), value) in subgrid.indexed_iter() {
+            array[[imu2, ix1, ix2]] = value as f32;
+        }
+
+        Self {
+            array,
+            mu2_grid,
+            x1_grid,
+            x2_grid,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::lagrange_subgrid::LagrangeSubgridV2;
+    use crate::subgrid::{ExtraSubgridParams, SubgridParams};
+
+    #[test]
+    fn test_single_precision() {
+        let x = vec![
+            0.015625, 0.03125, 0.0625, 0.125, 0.1875, 0.25, 0.375, 0.5, 0.75, 1.0,
+        ];
+        let mut grid1: SubgridEnum = SinglePrecisionSubgridV1::new(
+            SparseArray3::new(1, 10, 10),
+            vec![Mu2 { ren: 0.0, fac: 0.0 }],
+            x.clone(),
+            x.clone(),
+        )
+        .into();
+
+        let mu2 = vec![Mu2 { ren: 0.0, fac: 0.0 }];
+
+        assert_eq!(grid1.mu2_grid().as_ref(), mu2);
+        assert_eq!(grid1.x1_grid().as_ref(), x);
+        assert_eq!(grid1.x2_grid(), grid1.x1_grid());
+
+        assert!(grid1.is_empty());
+
+        // only use exactly representable numbers here so that we can avoid using approx_eq
+        if let SubgridEnum::SinglePrecisionSubgridV1(ref mut x) = grid1 {
+            x.array_mut()[[0, 1, 2]] = 1.0;
+            x.array_mut()[[0, 1, 3]] = 2.0;
+            x.array_mut()[[0, 4, 3]] = 4.0;
+            x.array_mut()[[0, 7, 1]] = 8.0;
+        } else {
+            unreachable!();
+        }
+
+        assert!(!grid1.is_empty());
+
+        assert_eq!(grid1.indexed_iter().next(), Some(((0, 1, 2), 1.0)));
+        assert_eq!(grid1.indexed_iter().nth(1), Some(((0, 1, 3), 2.0)));
+        assert_eq!(grid1.indexed_iter().nth(2), Some(((0, 4, 3), 4.0)));
+        assert_eq!(grid1.indexed_iter().nth(3), Some(((0, 7, 1), 8.0)));
+
+        // symmetric luminosity function
+        let lumi =
+            &mut (|ix1, ix2, _| x[ix1] * x[ix2]) as &mut dyn FnMut(usize, usize, usize) -> f64;
+
+        assert_eq!(grid1.convolve(&x, &x, &mu2, lumi), 0.228515625);
+
+        // create grid with transposed entries, but different q2
+        let mut grid2: SubgridEnum = SinglePrecisionSubgridV1::new(
+            SparseArray3::new(1, 10, 10),
+            vec![Mu2 { ren: 1.0, fac: 1.0 }],
+            x.clone(),
+            x.clone(),
+        )
+        .into();
+        if let SubgridEnum::SinglePrecisionSubgridV1(ref mut x) = grid2 {
+            x.array_mut()[[0, 2, 1]] = 1.0;
+            x.array_mut()[[0, 3, 1]] = 2.0;
+            x.array_mut()[[0, 3, 4]] = 4.0;
+            x.array_mut()[[0, 1, 7]] = 8.0;
+        } else {
+            unreachable!();
+        }
+        assert_eq!(grid2.convolve(&x, &x, &mu2, lumi), 0.228515625);
+
+        grid1.merge(&mut grid2, false);
+
+        assert_eq!(grid1.convolve(&x, &x, &mu2, lumi), 2.0 * 0.228515625);
+
+        let mut grid1 = {
+            let mut g = grid1.clone_empty();
+            g.merge(&mut grid1, false);
+            g
+        };
+
+        // the luminosity function is symmetric, so after symmetrization the result must be
+        // unchanged
+        grid1.symmetrize();
+        assert_eq!(grid1.convolve(&x, &x, &mu2, lumi), 2.0 * 0.228515625);
+
+        grid1.scale(2.0);
+        assert_eq!(grid1.convolve(&x, &x, &mu2, lumi), 4.0 * 0.228515625);
+
+        assert_eq!(
+            grid1.stats(),
+            Stats {
+                total: 200,
+                allocated: 14,
+                zeros: 6,
+                overhead: 42,
+                bytes_per_value: 4,
+            }
+        );
+    }
+
+    #[test]
+    #[should_panic(expected = "SinglePrecisionSubgridV1 doesn't support the fill operation")]
+    fn fill_panic() {
+        let mut grid = SinglePrecisionSubgridV1::new(
+            SparseArray3::new(1, 1, 1),
+            vec![Mu2 { ren: 1.0, fac: 1.0 }],
+            vec![1.0],
+            vec![1.0],
+        );
+
+        grid.fill(&Ntuple {
+            x1: 0.0,
+            x2: 0.0,
+            q2: 0.0,
+            weight: 1.0,
+        });
+    }
+
+    #[test]
+    fn from_lagrange_subgrid_v2() {
+        let mut lagrange =
+            LagrangeSubgridV2::new(&SubgridParams::default(), &ExtraSubgridParams::default());
+
+        lagrange.fill(&Ntuple {
+            x1: 0.25,
+            x2: 0.5,
+            q2: 10000.0,
+            weight: 1.0,
+        });
+        lagrange.fill(&Ntuple {
+            x1: 0.0625,
+            x2: 0.125,
+            q2: 10001.0,
+            weight: 1.0,
+        });
+        lagrange.fill(&Ntuple {
+            x1: 0.5,
+            x2: 0.0625,
+            q2: 10002.0,
+            weight: 1.0,
+        });
+        lagrange.fill(&Ntuple {
+            x1: 0.1,
+            x2: 0.2,
+            q2: 10003.0,
+            weight: 1.0,
+        });
+
+        let x1 = lagrange.x1_grid().to_vec();
+        let x2 = lagrange.x2_grid().to_vec();
+        let mu2 = lagrange.mu2_grid().to_vec();
+
+        let lumi = &mut (|_, _, _| 1.0) as &mut dyn FnMut(usize, usize, usize) -> f64;
+        let reference = lagrange.convolve(&x1, &x2, &mu2, lumi);
+
+        let converted = SinglePrecisionSubgridV1::from(&lagrange.into());
+        let test = converted.convolve(&x1, &x2, &mu2, lumi);
+
+        // the conversion rounds every weight once, so the result agrees to single precision
+        assert!((test / reference - 1.0).abs() < 1e-6);
+
+        // the subgrid must store half as many bytes per weight
+        assert_eq!(converted.stats().bytes_per_value, 4);
+    }
+}
@@ -5,6 +5,7 @@ use super::grid::Ntuple;
 use super::import_only_subgrid::{ImportOnlySubgridV1, ImportOnlySubgridV2};
 use super::lagrange_subgrid::{LagrangeSparseSubgridV1, LagrangeSubgridV1, LagrangeSubgridV2};
 use super::ntuple_subgrid::NtupleSubgridV1;
+use super::single_precision_subgrid::SinglePrecisionSubgridV1;
 use enum_dispatch::enum_dispatch;
 use ndarray::Array3;
 use serde::{Deserialize, Serialize};
@@ -30,6 +31,8 @@ pub enum SubgridEnum {
     /// Same as [`ImportOnlySubgridV1`], but with support for different renormalization and
     /// factorization scales choices.
     ImportOnlySubgridV2,
+    /// Same as [`ImportOnlySubgridV2`], but with the weights stored in single precision.
+    SinglePrecisionSubgridV1,
 }
 
 /// Structure denoting renormalization and factorization scale values.
@@ -142,6 +145,10 @@ pub type SubgridIndexedIter<'a> = Box<dyn Iterator<Item = ((usize, usize, usize)
 /// Subgrid creation parameters for subgrids that perform interpolation.
 #[derive(Clone, Debug, Deserialize, Serialize)]
 pub struct SubgridParams {
+    // this setting only applies while a subgrid is being filled, so it is not serialized and
+    // grids written by older versions deserialize with the default
+    #[serde(skip)]
+    allocate_upfront: bool,
     q2_bins: usize,
     q2_max: f64,
     q2_min: f64,
@@ -156,6 +163,7 @@ pub struct SubgridParams {
 impl Default for SubgridParams {
     fn default() -> Self {
         Self {
+            allocate_upfront: false,
             q2_bins: 40,
             q2_max: 1e8,
             q2_min: 1e2,
@@ -170,6 +178,20 @@ impl Default for SubgridParams {
 }
 
 impl SubgridParams {
+    /// Returns whether the storage of a subgrid is allocated in one piece at the first fill.
+    #[must_use]
+    pub const fn allocate_upfront(&self) -> bool {
+        self.allocate_upfront
+    }
+
+    /// Sets whether the storage of a subgrid is allocated in one piece at the first fill,
+    /// covering the entire $Q^2$ axis, instead of growing with the range of filled scales. This
+    /// avoids the repeated reallocation and copying of subgrid storage in fill-heavy runs, at the
+    /// cost of larger subgrids until [`crate::grid::Grid::optimize`] prunes them.
+    pub fn set_allocate_upfront(&mut self, allocate_upfront: bool) {
+        self.allocate_upfront = allocate_upfront;
+    }
+
     /// Returns the number of bins for the $Q^2$ axis.
     #[must_use]
     pub const fn q2_bins(&self) -> usize {
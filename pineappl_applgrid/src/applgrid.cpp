@@ -9,9 +9,12 @@
 #include <string>
 #include <vector>
 
-void* user_data = nullptr;
-rust::Fn<void(double const&, double const&, double*, void*)>* xfx = nullptr;
-rust::Fn<double(double const&, void*)>* alphas = nullptr;
+// `appl::grid::vconvolute` only accepts stateless function pointers, so the callback state must
+// live outside the call; making it `thread_local` keeps concurrent convolutions on different
+// threads from overwriting each other's state
+thread_local void* user_data = nullptr;
+thread_local rust::Fn<void(double const&, double const&, double*, void*)>* xfx = nullptr;
+thread_local rust::Fn<double(double const&, void*)>* alphas = nullptr;
 
 template <typename T>
 rust::Vec<T> std_vector_to_rust_vec(std::vector<T> vector)
@@ -138,7 +141,6 @@ rust::Vec<double> grid_convolve_with_one(
     double fscale,
     double escale
 ) {
-    // TODO: using global variables isn't thread-safe
     ::user_data = user_data;
     ::xfx = &xfx;
     ::alphas = &alphas;
@@ -173,6 +175,47 @@ void sparse_matrix_set(SparseMatrix3d& matrix, int x, int y, int z, double value
     matrix(x, y, z) = value;
 }
 
+void sparse_matrix_export(
+    SparseMatrix3d const& matrix,
+    int nx,
+    int ny,
+    int nz,
+    rust::Vec<int>& indices,
+    rust::Vec<double>& values
+) {
+    indices.clear();
+    values.clear();
+
+    for (int x = 0; x != nx; ++x) {
+        for (int y = 0; y != ny; ++y) {
+            for (int z = 0; z != nz; ++z) {
+                double const value = matrix(x, y, z);
+
+                if (value != 0.0) {
+                    indices.push_back((x * ny + y) * nz + z);
+                    values.push_back(value);
+                }
+            }
+        }
+    }
+}
+
+void sparse_matrix_set_bulk(
+    SparseMatrix3d& matrix,
+    rust::Slice<int const> x,
+    rust::Slice<int const> y,
+    rust::Slice<int const> z,
+    rust::Slice<double const> values
+) {
+    assert(x.size() == values.size());
+    assert(y.size() == values.size());
+    assert(z.size() == values.size());
+
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        matrix(x[i], y[i], z[i]) = values[i];
+    }
+}
+
 double weightfun(double x)
 {
     return appl::igrid::weightfun(x);
@@ -73,6 +73,23 @@ double sparse_matrix_get(SparseMatrix3d const& matrix, int x, int y, int z);
 
 void sparse_matrix_set(SparseMatrix3d& matrix, int x, int y, int z, double value);
 
+void sparse_matrix_export(
+    SparseMatrix3d const& matrix,
+    int nx,
+    int ny,
+    int nz,
+    rust::Vec<int>& indices,
+    rust::Vec<double>& values
+);
+
+void sparse_matrix_set_bulk(
+    SparseMatrix3d& matrix,
+    rust::Slice<int const> x,
+    rust::Slice<int const> y,
+    rust::Slice<int const> z,
+    rust::Slice<double const> values
+);
+
 double weightfun(double x);
 
 bool igrid_m_reweight(appl::igrid const& igrid);
@@ -11,12 +11,8 @@
 #![allow(missing_docs)]
 
 use lhapdf::Pdf;
-use std::mem;
 use std::pin::Pin;
 use std::slice;
-use std::sync::{Mutex, OnceLock};
-
-static MUTEX: OnceLock<Mutex<()>> = OnceLock::new();
 
 #[cxx::bridge]
 pub mod ffi {
@@ -138,6 +134,21 @@ pub mod ffi {
 
         fn sparse_matrix_get(_: &SparseMatrix3d, _: i32, _: i32, _: i32) -> f64;
         fn sparse_matrix_set(_: Pin<&mut SparseMatrix3d>, _: i32, _: i32, _: i32, _: f64);
+        fn sparse_matrix_export(
+            _: &SparseMatrix3d,
+            _: i32,
+            _: i32,
+            _: i32,
+            _: &mut Vec<i32>,
+            _: &mut Vec<f64>,
+        );
+        fn sparse_matrix_set_bulk(
+            _: Pin<&mut SparseMatrix3d>,
+            _: &[i32],
+            _: &[i32],
+            _: &[i32],
+            _: &[f64],
+        );
 
         // TODO: class member functions aren't supported yet by cxx, see
         // https://github.com/dtolnay/cxx/issues/447
@@ -174,13 +185,8 @@ pub fn grid_convolve_with_one(
         pdf.alphas_q2(*q * *q)
     };
 
-    let lock = MUTEX
-        .get_or_init(|| Mutex::new(()))
-        .lock()
-        // UNWRAP: if this fails there's an unexpected bug somewhere
-        .unwrap_or_else(|_| unreachable!());
-
-    let results = unsafe {
+    // the callback state in `applgrid.cpp` is `thread_local`, so no locking is needed here
+    unsafe {
         ffi::grid_convolve_with_one(
             grid,
             xfx,
@@ -191,9 +197,5 @@ pub fn grid_convolve_with_one(
             fscale,
             escale,
         )
-    };
-
-    mem::drop(lock);
-
-    results
+    }
 }
@@ -7,10 +7,12 @@
 #include <pineappl_capi.h>
 #include <LHAPDF/LHAPDF.h>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <utility>
 
 /** @brief Object oriented interface to PineAPPL.  */
 namespace PineAPPL {
@@ -26,15 +28,32 @@ struct KeyVal {
 
   KeyVal(const KeyVal &) = delete;
 
-  KeyVal(KeyVal &&) = delete;
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  KeyVal(KeyVal &&other) : raw(other.raw) { other.raw = nullptr; }
 
   KeyVal &operator=(const KeyVal &) = delete;
 
-  KeyVal &operator=(KeyVal &&) = delete;
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  KeyVal &operator=(KeyVal &&other) {
+    if (this != &other) {
+      pineappl_keyval_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
 
   /** @brief Destructor. */
   ~KeyVal() { pineappl_keyval_delete(this->raw); }
 
+  /** @brief Release ownership of the underlying raw object. The caller is
+   * responsible for deleting it with `pineappl_keyval_delete`. */
+  pineappl_keyval *release() {
+    pineappl_keyval *res = this->raw;
+    this->raw = nullptr;
+    return res;
+  }
+
   /** @name Setter. */
   ///@{
   void set_double(const std::string &key, const double value) const {
@@ -88,17 +107,37 @@ struct Lumi {
   /** @brief Constructor. */
   Lumi() : raw(pineappl_lumi_new()) {}
 
+  /** @brief Constructor taking ownership of a raw object. */
+  explicit Lumi(pineappl_lumi *raw) : raw(raw) {}
+
   Lumi(const Lumi &) = delete;
 
-  Lumi(Lumi &&) = delete;
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  Lumi(Lumi &&other) : raw(other.raw) { other.raw = nullptr; }
 
   Lumi &operator=(const Lumi &) = delete;
 
-  Lumi &operator=(Lumi &&) = delete;
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  Lumi &operator=(Lumi &&other) {
+    if (this != &other) {
+      pineappl_lumi_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
 
   /** @brief Destructor. */
   ~Lumi() { pineappl_lumi_delete(this->raw); }
 
+  /** @brief Release ownership of the underlying raw object. The caller is
+   * responsible for deleting it with `pineappl_lumi_delete`. */
+  pineappl_lumi *release() {
+    pineappl_lumi *res = this->raw;
+    this->raw = nullptr;
+    return res;
+  }
+
   /** @brief Number of elements. */
   std::size_t count() const { return pineappl_lumi_count(this->raw); }
 
@@ -118,6 +157,30 @@ struct Lumi {
     pineappl_lumi_add(this->raw, n, pids.data(), weights.data());
   }
 
+  /**
+   * @brief Add many luminosity functions with a single call.
+   * All channels are flattened into one set of arrays, so only one library
+   * call is made no matter how many channels are defined; this is
+   * considerably faster than calling `add` once per channel.
+   * @param channels one luminosity function per element
+   */
+  void add_many(const std::vector<std::vector<LumiEntry>> &channels) const {
+    std::vector<std::size_t> combinations;
+    std::vector<std::int32_t> pids;
+    std::vector<double> weights;
+    combinations.reserve(channels.size());
+    for (const std::vector<LumiEntry> &channel : channels) {
+      combinations.push_back(channel.size());
+      for (const LumiEntry &l : channel) {
+        pids.push_back(l.pid1);
+        pids.push_back(l.pid2);
+        weights.push_back(l.weight);
+      }
+    }
+    pineappl_lumi_add_many(this->raw, channels.size(), combinations.data(),
+                           pids.data(), weights.data());
+  }
+
   /**
    * @brief Returns the number of combinations of the luminosity function `lumi`
    * for the specified entry.
@@ -145,6 +208,212 @@ struct Order {
   std::uint32_t logxif;
 };
 
+/** @brief Handle for a grid write running on a background thread.
+ * Returned by `Grid::write_async`; the write finishes at the latest when this
+ * object is destroyed. */
+struct WriteHandle {
+
+  /** @brief Underlying raw object. */
+  pineappl_write_handle *raw;
+
+  /** @brief Constructor taking ownership of a raw object. */
+  explicit WriteHandle(pineappl_write_handle *raw) : raw(raw) {}
+
+  WriteHandle() = delete;
+
+  WriteHandle(const WriteHandle &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  WriteHandle(WriteHandle &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  WriteHandle &operator=(const WriteHandle &) = delete;
+
+  /** @brief Move assignment. Waits for this object's write to finish and
+   * leaves `other` without underlying object. */
+  WriteHandle &operator=(WriteHandle &&other) {
+    if (this != &other) {
+      this->wait();
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. Waits for the write to finish. */
+  ~WriteHandle() { this->wait(); }
+
+  /**
+   * @brief Returns whether the write has finished. Does not block. After
+   * `wait` or a move the underlying object is gone and the write has
+   * finished.
+   * @return true if the write has finished
+   */
+  bool done() const {
+    return (this->raw == nullptr) || pineappl_grid_write_done(this->raw);
+  }
+
+  /** @brief Wait until the write has finished. */
+  void wait() {
+    if (this->raw != nullptr) {
+      pineappl_grid_write_wait(this->raw);
+      this->raw = nullptr;
+    }
+  }
+};
+
+/** @brief Precompiled convolution plan. Created by `Grid::convolve_plan` and
+ * executed by `Grid::convolve_with_plan`; must be recompiled after the grid
+ * has been modified. */
+struct ConvolvePlan {
+
+  /** @brief Underlying raw object. */
+  pineappl_convolve_plan *raw;
+
+  /** @brief Constructor taking ownership of a raw object. */
+  explicit ConvolvePlan(pineappl_convolve_plan *raw) : raw(raw) {}
+
+  ConvolvePlan() = delete;
+
+  ConvolvePlan(const ConvolvePlan &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  ConvolvePlan(ConvolvePlan &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  ConvolvePlan &operator=(const ConvolvePlan &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  ConvolvePlan &operator=(ConvolvePlan &&other) {
+    if (this != &other) {
+      pineappl_convolve_plan_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. */
+  ~ConvolvePlan() { pineappl_convolve_plan_delete(this->raw); }
+};
+
+/** @brief Dense table of PDF values at the interpolation nodes of a grid.
+ * Created by `Grid::pdf_table`, filled by the caller (or by `fill`) and
+ * consumed by `Grid::convolve_with_table`; must be rebuilt after the grid has
+ * been modified. */
+struct PdfTable {
+
+  /** @brief Underlying raw object. */
+  pineappl_pdf_table *raw;
+
+  /** @brief Constructor taking ownership of a raw object. */
+  explicit PdfTable(pineappl_pdf_table *raw) : raw(raw) {}
+
+  PdfTable() = delete;
+
+  PdfTable(const PdfTable &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  PdfTable(PdfTable &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  PdfTable &operator=(const PdfTable &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  PdfTable &operator=(PdfTable &&other) {
+    if (this != &other) {
+      pineappl_pdf_table_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. */
+  ~PdfTable() { pineappl_pdf_table_delete(this->raw); }
+
+  /**
+   * @brief PDG ids for which PDF values must be supplied.
+   * @return PDG ids
+   */
+  std::vector<std::int32_t> pids() const {
+    std::vector<std::int32_t> res(pineappl_pdf_table_pid_count(this->raw));
+    pineappl_pdf_table_pids(this->raw, res.data());
+    return res;
+  }
+
+  /**
+   * @brief Unique momentum fractions of the interpolation nodes.
+   * @return momentum fractions
+   */
+  std::vector<double> x() const {
+    std::vector<double> res(pineappl_pdf_table_x_count(this->raw));
+    pineappl_pdf_table_x(this->raw, res.data());
+    return res;
+  }
+
+  /**
+   * @brief Unique factorization scales of the interpolation nodes.
+   * @return factorization scales
+   */
+  std::vector<double> muf2() const {
+    std::vector<double> res(pineappl_pdf_table_muf2_count(this->raw));
+    pineappl_pdf_table_muf2(this->raw, res.data());
+    return res;
+  }
+
+  /**
+   * @brief Unique renormalization scales of the interpolation nodes.
+   * @return renormalization scales
+   */
+  std::vector<double> mur2() const {
+    std::vector<double> res(pineappl_pdf_table_mur2_count(this->raw));
+    pineappl_pdf_table_mur2(this->raw, res.data());
+    return res;
+  }
+
+  /**
+   * @brief Pointer to the PDF values that must be filled before the
+   * convolution.
+   * The array has `pid_count * muf2_count * x_count` entries; the value for
+   * the parton `pids()[ipid]` at `x()[ix]` and `muf2()[imuf2]` is stored at
+   * the index `(ipid * muf2_count + imuf2) * x_count + ix`.
+   * @return pointer to the PDF values
+   */
+  double *values() const { return pineappl_pdf_table_values(this->raw); }
+
+  /**
+   * @brief Pointer to the strong-coupling values that must be filled before
+   * the convolution, one for each scale in `mur2()`.
+   * @return pointer to the strong-coupling values
+   */
+  double *alphas() const { return pineappl_pdf_table_alphas(this->raw); }
+
+  /**
+   * @brief Fill the table from an LHAPDF object.
+   * Evaluates `pdf` at every node; callers that vectorize the PDF evaluation
+   * themselves can fill `values` and `alphas` directly instead.
+   * @param pdf PDF
+   */
+  void fill(LHAPDF::PDF &pdf) const {
+    const std::vector<std::int32_t> pids = this->pids();
+    const std::vector<double> x = this->x();
+    const std::vector<double> muf2 = this->muf2();
+    const std::vector<double> mur2 = this->mur2();
+    double *values = this->values();
+    double *alphas = this->alphas();
+
+    for (std::size_t ipid = 0; ipid != pids.size(); ++ipid) {
+      for (std::size_t imuf2 = 0; imuf2 != muf2.size(); ++imuf2) {
+        for (std::size_t ix = 0; ix != x.size(); ++ix) {
+          values[(ipid * muf2.size() + imuf2) * x.size() + ix] =
+              pdf.xfxQ2(pids[ipid], x[ix], muf2[imuf2]);
+        }
+      }
+    }
+    for (std::size_t imur2 = 0; imur2 != mur2.size(); ++imur2) {
+      alphas[imur2] = pdf.alphasQ2(mur2[imur2]);
+    }
+  }
+};
+
 /** @brief The central grid object. */
 struct Grid {
 
@@ -174,19 +443,68 @@ struct Grid {
                                   key_val.raw);
   }
 
+  /**
+   * @brief Constructor defining all channels directly.
+   * Equivalent to building a `Lumi` with `add_many` and passing it to the
+   * other constructor, but without the intermediate object; useful when grids
+   * with many channels are constructed frequently.
+   * @param channels one luminosity function per element
+   * @param orders orders
+   * @param bin_limits bin limits
+   * @param key_val additional informations
+   */
+  Grid(const std::vector<std::vector<LumiEntry>> &channels,
+       const std::vector<Order> &orders, const std::vector<double> &bin_limits,
+       const KeyVal &key_val) {
+    Lumi lumi;
+    lumi.add_many(channels);
+    // cast orders
+    const std::size_t n_orders = orders.size();
+    std::vector<std::uint32_t> raw_orders;
+    for (const Order &order : orders) {
+      raw_orders.push_back(order.alphas);
+      raw_orders.push_back(order.alpha);
+      raw_orders.push_back(order.logxir);
+      raw_orders.push_back(order.logxif);
+    }
+    this->raw = pineappl_grid_new(lumi.raw, n_orders, raw_orders.data(),
+                                  bin_limits.size() - 1, bin_limits.data(),
+                                  key_val.raw);
+  }
+
+  /** @brief Constructor taking ownership of a raw object. */
+  explicit Grid(pineappl_grid *raw) : raw(raw) {}
+
   Grid() = delete;
 
   Grid(const Grid &) = delete;
 
-  Grid(Grid &&) = delete;
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  Grid(Grid &&other) : raw(other.raw) { other.raw = nullptr; }
 
   Grid &operator=(const Grid &) = delete;
 
-  Grid &operator=(Grid &&) = delete;
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  Grid &operator=(Grid &&other) {
+    if (this != &other) {
+      pineappl_grid_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
 
   /** @brief Destructor. */
   ~Grid() { pineappl_grid_delete(this->raw); }
 
+  /** @brief Release ownership of the underlying raw object. The caller is
+   * responsible for deleting it with `pineappl_grid_delete`. */
+  pineappl_grid *release() {
+    pineappl_grid *res = this->raw;
+    this->raw = nullptr;
+    return res;
+  }
+
   /**
    * @brief Number of orders.
    * @return number of orders
@@ -217,6 +535,28 @@ struct Grid {
     pineappl_grid_fill(this->raw, x1, x2, q2, order, observable, lumi, weight);
   }
 
+  /**
+   * @brief Fill grid with as many events as given by the size of the arrays.
+   * All arrays must have the same size.
+   * @param x1 first momentum fractions
+   * @param x2 second momentum fractions
+   * @param q2 scales
+   * @param orders order indices
+   * @param observables observable values
+   * @param lumis luminosity indices
+   * @param weights weights
+   */
+  void fill_array(const std::vector<double> &x1, const std::vector<double> &x2,
+                  const std::vector<double> &q2,
+                  const std::vector<std::size_t> &orders,
+                  const std::vector<double> &observables,
+                  const std::vector<std::size_t> &lumis,
+                  const std::vector<double> &weights) const {
+    pineappl_grid_fill_array(this->raw, x1.data(), x2.data(), q2.data(),
+                             orders.data(), observables.data(), lumis.data(),
+                             weights.data(), weights.size());
+  }
+
   /**
    * @brief Perform a convolution of the grid with PDFs.
    * @param pdg_id hadron ID
@@ -260,50 +600,975 @@ struct Grid {
   }
 
   /**
-   * @brief Write grid to file.
-   * @param filename file name
+   * @brief Extract the interpolation nodes of this grid into a PDF table.
+   * The table must be filled before calling `convolve_with_table` and
+   * rebuilt after the grid has been modified.
+   * @return PDF table
    */
-  void write(const std::string &filename) const {
-    pineappl_grid_write(this->raw, filename.c_str());
+  PdfTable pdf_table() const {
+    return PdfTable(pineappl_grid_pdf_table_new(this->raw));
   }
 
   /**
-   * @brief Set a metadata entry.
-   * @param key key
-   * @param value value
+   * @brief Perform a convolution of the grid with a filled PDF table.
+   * No PDF callbacks are performed; the luminosity is a pure
+   * lookup-and-multiply over the table, which is the fastest way to
+   * repeatedly convolve the same grid with changing PDFs. Only the central
+   * scales are evaluated.
+   * @param table PDF table built from this grid
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return prediction for each bin
    */
-  void set_key_value(const std::string &key, const std::string &value) const {
-    pineappl_grid_set_key_value(this->raw, key.c_str(), value.c_str());
+  std::vector<double>
+  convolve_with_table(const PdfTable &table,
+                      const std::vector<bool> &order_mask = {},
+                      const std::vector<bool> &lumi_mask = {}) const {
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    std::vector<double> results(this->bin_count());
+    pineappl_grid_convolve_with_table(this->raw, table.raw,
+                                      raw_order_mask.get(),
+                                      raw_lumi_mask.get(), results.data());
+    return results;
   }
 
   /**
-   * @brief Get a metadata entry.
-   * @param key key
-   * @return value
+   * @brief Compile a convolution plan for this grid.
+   * The plan captures the subgrid traversal order and the per-channel PDF
+   * combinations after applying the masks; it must be recompiled after the
+   * grid has been modified.
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return convolution plan
    */
-  std::string get_key_value(const std::string &key) const {
-    auto *value = pineappl_grid_key_value(this->raw, key.c_str());
-    std::string res(value);
-    // delete the allocated object
-    pineappl_string_delete(value);
-    return res;
+  ConvolvePlan convolve_plan(const std::vector<bool> &order_mask = {},
+                             const std::vector<bool> &lumi_mask = {}) const {
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    return ConvolvePlan(pineappl_grid_convolve_plan_new(
+        this->raw, raw_order_mask.get(), raw_lumi_mask.get()));
   }
 
   /**
-   * @brief Scale grid with a number.
-   * This multiplies all subgrids with the given number.
-   * @param s factor
+   * @brief Perform a convolution of the grid with PDFs for many scale
+   * settings in a single pass over the subgrids.
+   * Executes the precompiled `plan` for all `(xi_ren, xi_fac)` pairs in
+   * `xi`, which is the preferred way to perform the customary 7-point scale
+   * variation.
+   * @param plan convolution plan compiled from this grid
+   * @param pdg_id hadron ID
+   * @param pdf PDF
+   * @param xi `(xi_ren, xi_fac)` pairs
+   * @return predictions, with the values of all scale settings of each bin
+   * stored consecutively
    */
-  void scale(const double s) const {
-    pineappl_grid_scale(this->raw, s);
+  std::vector<double>
+  convolve_with_plan(const ConvolvePlan &plan, const std::int32_t pdg_id,
+                     LHAPDF::PDF &pdf,
+                     const std::vector<std::pair<double, double>> &xi) const {
+    auto xfx = [](std::int32_t id, double x, double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x, q2);
+    };
+    auto alphas = [](double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->alphasQ2(q2);
+    };
+    std::vector<double> xi_ren;
+    std::vector<double> xi_fac;
+    xi_ren.reserve(xi.size());
+    xi_fac.reserve(xi.size());
+    for (const auto &point : xi) {
+      xi_ren.push_back(point.first);
+      xi_fac.push_back(point.second);
+    }
+    std::vector<double> results(this->bin_count() * xi.size());
+    pineappl_grid_convolve_with_plan(this->raw, plan.raw, pdg_id, xfx, alphas,
+                                     &pdf, xi_ren.data(), xi_fac.data(),
+                                     xi.size(), results.data());
+    return results;
   }
 
   /**
-   * @brief Optimizes the grid representation for space efficiency.
+   * @brief Return the distinct renormalization scales of the grid for the
+   * given scale variation, in ascending order. These are exactly the scales
+   * at which a convolution with the same `xi_ren` evaluates the strong
+   * coupling, so the running coupling can be solved once per node and passed
+   * to `convolve_with_one_alphas_table`.
+   * @param xi_ren renormalization scale variation
+   * @return distinct renormalization scales
    */
-  void optimize() const {
-    pineappl_grid_optimize(this->raw);
+  std::vector<double> mur2_nodes(const double xi_ren = 1.0) const {
+    std::vector<double> nodes(pineappl_grid_mur2_nodes_count(this->raw,
+                                                             xi_ren));
+    pineappl_grid_mur2_nodes(this->raw, xi_ren, nodes.data());
+    return nodes;
+  }
+
+  /**
+   * @brief Perform a convolution of the grid with PDFs, taking the strong
+   * coupling from a precomputed table instead of a callback. The table must
+   * contain the value of the strong coupling for each scale returned by
+   * `mur2_nodes` for the same `xi_ren`.
+   * @param pdg_id hadron ID
+   * @param pdf PDF
+   * @param mur2 scales returned by `mur2_nodes`
+   * @param alphas_table strong coupling for each scale in `mur2`
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return prediction for each bin
+   */
+  std::vector<double> convolve_with_one_alphas_table(
+      const std::int32_t pdg_id, LHAPDF::PDF &pdf,
+      const std::vector<double> &mur2, const std::vector<double> &alphas_table,
+      const double xi_ren = 1.0, const double xi_fac = 1.0,
+      const std::vector<bool> &order_mask = {},
+      const std::vector<bool> &lumi_mask = {}) const {
+    // prepare LHAPDF stuff
+    auto xfx = [](std::int32_t id, double x, double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x, q2);
+    };
+    // cast order_mask
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    // cast lumi mask
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    // do it!
+    std::vector<double> results(this->bin_count());
+    pineappl_grid_convolve_with_one_alphas_table(
+        this->raw, pdg_id, xfx, &pdf, mur2.data(), alphas_table.data(),
+        mur2.size(), raw_order_mask.get(), raw_lumi_mask.get(), xi_ren,
+        xi_fac, results.data());
+    return results;
   }
+
+  /**
+   * @brief Perform a convolution of the grid with PDFs using one worker
+   * thread per element of `pdfs`. The bins are partitioned across the
+   * threads and each thread only uses its own PDF object, so the LHAPDF
+   * objects are never shared between threads.
+   * @param pdg_id hadron ID
+   * @param pdfs one PDF object per worker thread, all for the same member
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return prediction for each bin
+   */
+  std::vector<double>
+  convolve_with_one_threaded(const std::int32_t pdg_id,
+                             const std::vector<LHAPDF::PDF *> &pdfs,
+                             const double xi_ren = 1.0,
+                             const double xi_fac = 1.0,
+                             const std::vector<bool> &order_mask = {},
+                             const std::vector<bool> &lumi_mask = {}) const {
+    // prepare LHAPDF stuff
+    auto xfx = [](std::int32_t id, double x, double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x, q2);
+    };
+    auto alphas = [](double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->alphasQ2(q2);
+    };
+    std::vector<void *> states(pdfs.begin(), pdfs.end());
+    // cast order_mask
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    // cast lumi mask
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    // do it!
+    std::vector<double> results(this->bin_count());
+    pineappl_grid_convolve_with_one_threaded(
+        this->raw, pdg_id, xfx, alphas, states.data(), states.size(),
+        raw_order_mask.get(), raw_lumi_mask.get(), xi_ren, xi_fac,
+        results.data());
+    return results;
+  }
+
+  /**
+   * @brief Perform convolutions of the grid with all given PDF members in a
+   * single pass. The subgrid traversal is shared by all members, which is
+   * considerably faster than calling `convolve_with_one` once per member —
+   * the typical pattern when computing PDF uncertainties.
+   * @param pdg_id hadron ID
+   * @param pdfs PDF members
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return predictions, member-by-member: the first `bin_count()` elements
+   * belong to the first member, and so on
+   */
+  std::vector<double>
+  convolve_with_members(const std::int32_t pdg_id,
+                        const std::vector<LHAPDF::PDF *> &pdfs,
+                        const double xi_ren = 1.0, const double xi_fac = 1.0,
+                        const std::vector<bool> &order_mask = {},
+                        const std::vector<bool> &lumi_mask = {}) const {
+    // prepare LHAPDF stuff
+    auto xfx = [](std::int32_t id, double x, double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x, q2);
+    };
+    auto alphas = [](double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->alphasQ2(q2);
+    };
+    std::vector<void *> states(pdfs.begin(), pdfs.end());
+    // cast order_mask
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    // cast lumi mask
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    // do it!
+    std::vector<double> results(pdfs.size() * this->bin_count());
+    pineappl_grid_convolve_with_one_multi(
+        this->raw, pdg_id, xfx, alphas, states.data(), states.size(),
+        raw_order_mask.get(), raw_lumi_mask.get(), xi_ren, xi_fac,
+        results.data());
+    return results;
+  }
+
+  /**
+   * @brief Perform a convolution of the grid with PDFs, evaluating the PDF
+   * in batches. Instead of one `xfxQ2` call per (parton, x, Q2) node, the
+   * library collects the distinct nodes of the grid and drives LHAPDF's
+   * interpolator over whole arrays — one call per parton ID — which is
+   * considerably faster for repeated convolutions.
+   * @param pdg_id hadron ID
+   * @param pdf PDF
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   * @return prediction for each bin
+   */
+  std::vector<double>
+  convolve_with_one_batched(const std::int32_t pdg_id, LHAPDF::PDF &pdf,
+                            const double xi_ren = 1.0,
+                            const double xi_fac = 1.0,
+                            const std::vector<bool> &order_mask = {},
+                            const std::vector<bool> &lumi_mask = {}) const {
+    // prepare LHAPDF stuff
+    auto xfx = [](std::int32_t id, const double *x, const double *q2,
+                  std::size_t size, double *results, void *pdf) {
+      for (std::size_t i = 0; i != size; ++i) {
+        results[i] = static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x[i], q2[i]);
+      }
+    };
+    auto alphas = [](double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->alphasQ2(q2);
+    };
+    // cast order_mask
+    std::unique_ptr<bool[]> raw_order_mask;
+    if (!order_mask.empty()) {
+      raw_order_mask = std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(), &raw_order_mask[0]);
+    }
+    // cast lumi mask
+    std::unique_ptr<bool[]> raw_lumi_mask;
+    if (!lumi_mask.empty()) {
+      raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &raw_lumi_mask[0]);
+    }
+    // do it!
+    std::vector<double> results(this->bin_count());
+    pineappl_grid_convolve_with_one_batched(
+        this->raw, pdg_id, xfx, alphas, &pdf, raw_order_mask.get(),
+        raw_lumi_mask.get(), xi_ren, xi_fac, results.data());
+    return results;
+  }
+
+  /**
+   * @brief Write grid to file.
+   * @param filename file name
+   */
+  void write(const std::string &filename) const {
+    pineappl_grid_write(this->raw, filename.c_str());
+  }
+
+  /**
+   * @brief Write grid to file on a background thread.
+   * The grid is snapshotted before this function returns, so filling may
+   * continue immediately while the compression and IO run in the background.
+   * @param filename file name
+   * @param compress whether to LZ4-compress the file; uncompressed writes are
+   * faster and suited for frequent checkpoints
+   * @return handle that the write can be waited on with
+   */
+  WriteHandle write_async(const std::string &filename,
+                          const bool compress) const {
+    return WriteHandle(
+        pineappl_grid_write_async(this->raw, filename.c_str(), compress));
+  }
+
+  /**
+   * @brief Read the grids stored in `filenames` and merge them into a single
+   * grid. The files are read and merged one at a time, so memory usage stays
+   * bounded no matter how many files are merged.
+   * @param filenames paths of the grid files to merge
+   * @return merged grid
+   */
+  static Grid merge_files(const std::vector<std::string> &filenames) {
+    std::vector<const char *> paths;
+    paths.reserve(filenames.size());
+    for (const std::string &filename : filenames) {
+      paths.push_back(filename.c_str());
+    }
+    return Grid(pineappl_grid_merge_files(paths.size(), paths.data()));
+  }
+
+  /**
+   * @brief Set a metadata entry.
+   * @param key key
+   * @param value value
+   */
+  void set_key_value(const std::string &key, const std::string &value) const {
+    pineappl_grid_set_key_value(this->raw, key.c_str(), value.c_str());
+  }
+
+  /**
+   * @brief Get a metadata entry.
+   * @param key key
+   * @return value
+   */
+  std::string get_key_value(const std::string &key) const {
+    auto *value = pineappl_grid_key_value(this->raw, key.c_str());
+    std::string res(value);
+    // delete the allocated object
+    pineappl_string_delete(value);
+    return res;
+  }
+
+  /**
+   * @brief Get all metadata entries with a single call.
+   * The entries are read through borrowed views, so only one string is
+   * allocated per key and value, instead of one library call plus an extra
+   * allocation and copy per entry.
+   * @return all keys and values
+   */
+  std::map<std::string, std::string> key_values() const {
+    const std::size_t count = pineappl_grid_key_value_count(this->raw);
+    std::vector<const char *> keys(count);
+    std::vector<std::size_t> key_lengths(count);
+    std::vector<const char *> values(count);
+    std::vector<std::size_t> value_lengths(count);
+    pineappl_grid_key_values(this->raw, keys.data(), key_lengths.data(),
+                             values.data(), value_lengths.data());
+    std::map<std::string, std::string> res;
+    for (std::size_t i = 0; i != count; ++i) {
+      res.emplace(std::string(keys[i], key_lengths[i]),
+                  std::string(values[i], value_lengths[i]));
+    }
+    return res;
+  }
+
+  /**
+   * @brief Read the instrumentation counters of this grid.
+   * The counters are always enabled, start at zero for every newly created or
+   * read grid and cover the fill and convolution hot paths.
+   * @return snapshot of the counters
+   */
+  pineappl_stats stats() const {
+    pineappl_stats res;
+    pineappl_grid_stats(this->raw, &res);
+    return res;
+  }
+
+  /**
+   * @brief Scale grid with a number.
+   * This multiplies all subgrids with the given number.
+   * @param s factor
+   */
+  void scale(const double s) const {
+    pineappl_grid_scale(this->raw, s);
+  }
+
+  /**
+   * @brief Optimizes the grid representation for space efficiency.
+   */
+  void optimize() const {
+    pineappl_grid_optimize(this->raw);
+  }
+};
+
+/** @brief A grid file that is opened lazily.
+ * `pineappl_grid_read` decompresses and materializes the whole grid up front,
+ * which is wasted work for programs that open many grids but access only a
+ * few of them. A `LazyGrid` only opens the file in its constructor; the grid
+ * is read on the first call of `grid` and cached afterwards. */
+struct LazyGrid {
+
+  /** @brief Underlying raw object. */
+  pineappl_lazy_grid *raw;
+
+  /**
+   * @brief Constructor. Opens the file without reading the grid.
+   * @param filename file name
+   */
+  explicit LazyGrid(const std::string &filename)
+      : raw(pineappl_grid_open_lazy(filename.c_str())) {}
+
+  LazyGrid() = delete;
+
+  LazyGrid(const LazyGrid &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  LazyGrid(LazyGrid &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  LazyGrid &operator=(const LazyGrid &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  LazyGrid &operator=(LazyGrid &&other) {
+    if (this != &other) {
+      pineappl_lazy_grid_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. Deletes the grid if it has been read. */
+  ~LazyGrid() { pineappl_lazy_grid_delete(this->raw); }
+
+  /**
+   * @brief Access the grid, reading it from disk on the first call.
+   * The returned pointer is owned by this object and stays valid until this
+   * object is destroyed; it must not be deleted by the caller.
+   * @return raw grid
+   */
+  pineappl_grid *grid() const { return pineappl_lazy_grid_grid(this->raw); }
+};
+
+/** @brief Metadata footer of a grid file.
+ * Grid files end with a small footer that duplicates the orders, channels,
+ * bin limits and key-value pairs of the grid. Reading it only requires a seek
+ * to the end of the file, so it is much cheaper than `pineappl_grid_read`
+ * when the subgrid data is not needed. */
+struct GridFooter {
+
+  /** @brief Underlying raw object. */
+  pineappl_grid_footer *raw;
+
+  /**
+   * @brief Constructor. Reads the footer without touching the subgrid data.
+   * @param filename file name
+   */
+  explicit GridFooter(const std::string &filename)
+      : raw(pineappl_grid_read_footer(filename.c_str())) {}
+
+  GridFooter() = delete;
+
+  GridFooter(const GridFooter &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  GridFooter(GridFooter &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  GridFooter &operator=(const GridFooter &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  GridFooter &operator=(GridFooter &&other) {
+    if (this != &other) {
+      pineappl_grid_footer_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. */
+  ~GridFooter() { pineappl_grid_footer_delete(this->raw); }
+
+  /**
+   * @brief Number of bins.
+   * @return number of bins
+   */
+  std::size_t bin_count() const {
+    return pineappl_grid_footer_bin_count(this->raw);
+  }
+
+  /**
+   * @brief Bin limits.
+   * @return the `bin_count() + 1` bin limits
+   */
+  std::vector<double> bin_limits() const {
+    std::vector<double> limits(this->bin_count() + 1);
+    pineappl_grid_footer_bin_limits(this->raw, limits.data());
+    return limits;
+  }
+
+  /**
+   * @brief Number of orders.
+   * @return number of orders
+   */
+  std::size_t order_count() const {
+    return pineappl_grid_footer_order_count(this->raw);
+  }
+
+  /**
+   * @brief Perturbative orders.
+   * @return orders
+   */
+  std::vector<Order> orders() const {
+    const std::size_t n_orders = this->order_count();
+    std::vector<std::uint32_t> raw_orders(4 * n_orders);
+    pineappl_grid_footer_order_params(this->raw, raw_orders.data());
+    std::vector<Order> res(n_orders);
+    for (std::size_t i = 0; i != n_orders; ++i) {
+      res[i].alphas = raw_orders[4 * i];
+      res[i].alpha = raw_orders[4 * i + 1];
+      res[i].logxir = raw_orders[4 * i + 2];
+      res[i].logxif = raw_orders[4 * i + 3];
+    }
+    return res;
+  }
+
+  /**
+   * @brief Channels as a luminosity function.
+   * @return luminosity function
+   */
+  Lumi lumi() const { return Lumi(pineappl_grid_footer_lumi(this->raw)); }
+
+  /**
+   * @brief Get a metadata entry.
+   * @param key key
+   * @return value
+   */
+  std::string get_key_value(const std::string &key) const {
+    auto *value = pineappl_grid_footer_key_value(this->raw, key.c_str());
+    std::string res(value);
+    // delete the allocated object
+    pineappl_string_delete(value);
+    return res;
+  }
+};
+
+/** @brief Reusable context for repeated convolutions of the same grid.
+ * `Grid::convolve_with_one` converts the order and luminosity masks and
+ * allocates a fresh results vector on every call. When the same grid is
+ * convolved many times — e.g. for every member of a PDF set and every scale
+ * variation — this per-call work is wasted. This context performs the mask
+ * conversion once in the constructor and keeps a results buffer that is
+ * reused by every convolution, so no allocation happens after the first
+ * call. */
+struct ConvolveContext {
+  /** @brief Grid this context convolves. */
+  const Grid &grid;
+
+  /**
+   * @brief Constructor.
+   * @param grid grid
+   * @param order_mask order mask
+   * @param lumi_mask luminosity mask
+   */
+  explicit ConvolveContext(const Grid &grid,
+                           const std::vector<bool> &order_mask = {},
+                           const std::vector<bool> &lumi_mask = {})
+      : grid(grid), results(grid.bin_count()) {
+    if (!order_mask.empty()) {
+      this->raw_order_mask =
+          std::unique_ptr<bool[]>(new bool[order_mask.size()]);
+      std::copy(order_mask.begin(), order_mask.end(),
+                &this->raw_order_mask[0]);
+    }
+    if (!lumi_mask.empty()) {
+      this->raw_lumi_mask = std::unique_ptr<bool[]>(new bool[lumi_mask.size()]);
+      std::copy(lumi_mask.begin(), lumi_mask.end(), &this->raw_lumi_mask[0]);
+    }
+  }
+
+  ConvolveContext() = delete;
+
+  ConvolveContext(const ConvolveContext &) = delete;
+
+  ConvolveContext(ConvolveContext &&) = delete;
+
+  ConvolveContext &operator=(const ConvolveContext &) = delete;
+
+  ConvolveContext &operator=(ConvolveContext &&) = delete;
+
+  /**
+   * @brief Perform a convolution of the grid with PDFs, writing the
+   * predictions into a caller-provided vector. The vector is resized to the
+   * number of bins, which allocates only if its capacity is too small.
+   * @param pdg_id hadron ID
+   * @param pdf PDF
+   * @param results prediction for each bin
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   */
+  void convolve_into(const std::int32_t pdg_id, LHAPDF::PDF &pdf,
+                     std::vector<double> &results, const double xi_ren = 1.0,
+                     const double xi_fac = 1.0) const {
+    auto xfx = [](std::int32_t id, double x, double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->xfxQ2(id, x, q2);
+    };
+    auto alphas = [](double q2, void *pdf) {
+      return static_cast<LHAPDF::PDF *>(pdf)->alphasQ2(q2);
+    };
+    results.resize(this->grid.bin_count());
+    pineappl_grid_convolve_with_one(this->grid.raw, pdg_id, xfx, alphas, &pdf,
+                                    this->raw_order_mask.get(),
+                                    this->raw_lumi_mask.get(), xi_ren, xi_fac,
+                                    results.data());
+  }
+
+  /**
+   * @brief Perform a convolution of the grid with PDFs, using the internal
+   * results buffer. The returned reference is valid until the next
+   * convolution with this context.
+   * @param pdg_id hadron ID
+   * @param pdf PDF
+   * @param xi_ren renormalization scale variation
+   * @param xi_fac factorization scale variation
+   * @return prediction for each bin
+   */
+  const std::vector<double> &
+  convolve_with_one(const std::int32_t pdg_id, LHAPDF::PDF &pdf,
+                    const double xi_ren = 1.0, const double xi_fac = 1.0) {
+    this->convolve_into(pdg_id, pdf, this->results, xi_ren, xi_fac);
+    return this->results;
+  }
+
+private:
+  std::unique_ptr<bool[]> raw_order_mask;
+  std::unique_ptr<bool[]> raw_lumi_mask;
+  std::vector<double> results;
+};
+
+/** @brief Collection of per-thread shards of a `Grid` for concurrent filling.
+ * `pineappl_grid_fill` is not thread-safe, so multi-threaded integrators must
+ * either serialize all fills through a mutex or fill independent grids. This
+ * class implements the latter: it creates one empty clone of a master grid per
+ * thread via `pineappl_grid_clone_empty`. Each thread may then fill its own
+ * shard without any synchronization, and `merge_into_master` finally merges
+ * all shards back into the master grid through
+ * `pineappl_grid_merge_and_delete`. */
+struct FillShards {
+  /** @brief Master grid the shards were cloned from. */
+  const Grid &master;
+
+  /**
+   * @brief Constructor.
+   * @param master master grid
+   * @param count number of shards, typically the number of threads
+   */
+  FillShards(const Grid &master, const std::size_t count) : master(master) {
+    this->shards.reserve(count);
+    for (std::size_t i = 0; i != count; ++i) {
+      this->shards.push_back(pineappl_grid_clone_empty(master.raw));
+    }
+  }
+
+  FillShards() = delete;
+
+  FillShards(const FillShards &) = delete;
+
+  FillShards(FillShards &&) = delete;
+
+  FillShards &operator=(const FillShards &) = delete;
+
+  FillShards &operator=(FillShards &&) = delete;
+
+  /** @brief Destructor. Deletes all shards that have not been merged. */
+  ~FillShards() {
+    for (pineappl_grid *shard : this->shards) {
+      pineappl_grid_delete(shard);
+    }
+  }
+
+  /** @brief Number of shards. */
+  std::size_t count() const { return this->shards.size(); }
+
+  /**
+   * @brief Fill the shard with the given index. Calls for different shard
+   * indices may run concurrently; each shard must only be filled by one thread
+   * at a time.
+   * @param shard shard index
+   * @param x1 first momentum fraction
+   * @param x2 second momentum fraction
+   * @param q2 scale
+   * @param order order index
+   * @param observable observable value
+   * @param lumi luminosity index
+   * @param weight weight
+   */
+  void fill(const std::size_t shard, const double x1, const double x2,
+            const double q2, const std::size_t order, const double observable,
+            const std::size_t lumi, const double weight) const {
+    pineappl_grid_fill(this->shards[shard], x1, x2, q2, order, observable,
+                       lumi, weight);
+  }
+
+  /** @brief Merge all shards into the master grid and delete them. Must not
+   * be called while any thread is still filling. */
+  void merge_into_master() {
+    for (pineappl_grid *&shard : this->shards) {
+      pineappl_grid_merge_and_delete(this->master.raw, shard);
+      shard = nullptr;
+    }
+    this->shards.clear();
+  }
+
+private:
+  std::vector<pineappl_grid *> shards;
+};
+
+/** @brief Event buffer that batches fill calls before passing them on to a
+ * `Grid`. Each call to `fill` only appends the event to internal arrays; once
+ * `capacity` events have accumulated they are flushed through
+ * `pineappl_grid_fill_array` in a single call, which amortizes the overhead of
+ * crossing the C API for every single event. The destructor flushes all events
+ * that are still buffered. */
+struct FillBuffer {
+  /** @brief Grid that receives the buffered events. */
+  const Grid &grid;
+
+  /**
+   * @brief Constructor.
+   * @param grid grid that receives the buffered events
+   * @param capacity number of events buffered before an automatic flush
+   */
+  explicit FillBuffer(const Grid &grid, const std::size_t capacity = 65536)
+      : grid(grid), capacity(capacity) {
+    this->x1.reserve(capacity);
+    this->x2.reserve(capacity);
+    this->q2.reserve(capacity);
+    this->orders.reserve(capacity);
+    this->observables.reserve(capacity);
+    this->lumis.reserve(capacity);
+    this->weights.reserve(capacity);
+  }
+
+  FillBuffer() = delete;
+
+  FillBuffer(const FillBuffer &) = delete;
+
+  FillBuffer(FillBuffer &&) = delete;
+
+  FillBuffer &operator=(const FillBuffer &) = delete;
+
+  FillBuffer &operator=(FillBuffer &&) = delete;
+
+  /** @brief Destructor. Flushes all remaining events. */
+  ~FillBuffer() { this->flush(); }
+
+  /**
+   * @brief Buffer a single event; flushes automatically when the buffer is
+   * full.
+   * @param x1 first momentum fraction
+   * @param x2 second momentum fraction
+   * @param q2 scale
+   * @param order order index
+   * @param observable observable value
+   * @param lumi luminosity index
+   * @param weight weight
+   */
+  void fill(const double x1, const double x2, const double q2,
+            const std::size_t order, const double observable,
+            const std::size_t lumi, const double weight) {
+    this->x1.push_back(x1);
+    this->x2.push_back(x2);
+    this->q2.push_back(q2);
+    this->orders.push_back(order);
+    this->observables.push_back(observable);
+    this->lumis.push_back(lumi);
+    this->weights.push_back(weight);
+    if (this->weights.size() == this->capacity) {
+      this->flush();
+    }
+  }
+
+  /** @brief Pass all buffered events to the grid and empty the buffer. */
+  void flush() {
+    if (this->weights.empty()) {
+      return;
+    }
+    pineappl_grid_fill_array(this->grid.raw, this->x1.data(), this->x2.data(),
+                             this->q2.data(), this->orders.data(),
+                             this->observables.data(), this->lumis.data(),
+                             this->weights.data(), this->weights.size());
+    this->x1.clear();
+    this->x2.clear();
+    this->q2.clear();
+    this->orders.clear();
+    this->observables.clear();
+    this->lumis.clear();
+    this->weights.clear();
+  }
+
+  /** @brief Number of events currently buffered. */
+  std::size_t size() const { return this->weights.size(); }
+
+private:
+  std::size_t capacity;
+  std::vector<double> x1;
+  std::vector<double> x2;
+  std::vector<double> q2;
+  std::vector<std::size_t> orders;
+  std::vector<double> observables;
+  std::vector<std::size_t> lumis;
+  std::vector<double> weights;
+};
+
+/** @brief Token for the unchecked fast-path fill of a fixed order and
+ * luminosity index. The indices are validated once in the constructor; `fill`
+ * then skips all per-event checks, which matters in generator inner loops
+ * where the same order and luminosity are filled billions of times. The grid
+ * must outlive the token and must not be structurally modified while the
+ * token exists. */
+struct FillToken {
+
+  /** @brief Underlying raw object. */
+  pineappl_fill_token *raw;
+
+  /**
+   * @brief Constructor. Validates `order` and `lumi` for `grid`.
+   * @param grid grid to fill
+   * @param order order index
+   * @param lumi luminosity index
+   */
+  FillToken(const Grid &grid, const std::size_t order, const std::size_t lumi)
+      : raw(pineappl_grid_fill_token(grid.raw, order, lumi)) {}
+
+  FillToken() = delete;
+
+  FillToken(const FillToken &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  FillToken(FillToken &&other) : raw(other.raw) { other.raw = nullptr; }
+
+  FillToken &operator=(const FillToken &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  FillToken &operator=(FillToken &&other) {
+    if (this != &other) {
+      pineappl_fill_token_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. Does not delete the grid. */
+  ~FillToken() { pineappl_fill_token_delete(this->raw); }
+
+  /**
+   * @brief Fill the grid for the validated order and luminosity index without
+   * per-event checks.
+   * @param x1 first momentum fraction
+   * @param x2 second momentum fraction
+   * @param q2 scale
+   * @param observable observable value
+   * @param weight weight
+   */
+  void fill(const double x1, const double x2, const double q2,
+            const double observable, const double weight) const {
+    pineappl_grid_fill_unchecked(this->raw, x1, x2, q2, observable, weight);
+  }
+};
+
+/** @brief Compacts cold subgrids while a grid is being filled.
+ * `Grid::optimize` is a one-shot pass after filling, so during a long fill
+ * run sparse, unpruned subgrids accumulate and the resident size can grow
+ * far beyond the optimized footprint. Filling through this object instead
+ * compacts all subgrids that were not filled during the last `interval`
+ * events; events hitting a compacted subgrid are merged into it, so no fills
+ * are lost. The grid must outlive this object. */
+struct IncrementalOptimizer {
+
+  /** @brief Underlying raw object. */
+  pineappl_incremental_optimizer *raw;
+
+  /**
+   * @brief Constructor.
+   * @param grid grid to fill
+   * @param interval number of fills between two compactions; zero disables
+   * automatic compaction so that `compact` can be driven by a memory budget
+   */
+  IncrementalOptimizer(const Grid &grid, const std::size_t interval)
+      : raw(pineappl_incremental_optimizer_new(grid.raw, interval)) {}
+
+  IncrementalOptimizer() = delete;
+
+  IncrementalOptimizer(const IncrementalOptimizer &) = delete;
+
+  /** @brief Move constructor. Leaves `other` without underlying object. */
+  IncrementalOptimizer(IncrementalOptimizer &&other) : raw(other.raw) {
+    other.raw = nullptr;
+  }
+
+  IncrementalOptimizer &operator=(const IncrementalOptimizer &) = delete;
+
+  /** @brief Move assignment. Leaves `other` without underlying object. */
+  IncrementalOptimizer &operator=(IncrementalOptimizer &&other) {
+    if (this != &other) {
+      pineappl_incremental_optimizer_delete(this->raw);
+      this->raw = other.raw;
+      other.raw = nullptr;
+    }
+    return *this;
+  }
+
+  /** @brief Destructor. Does not delete the grid. */
+  ~IncrementalOptimizer() { pineappl_incremental_optimizer_delete(this->raw); }
+
+  /**
+   * @brief Fill the grid and compact cold subgrids when the interval has
+   * passed.
+   * @param x1 first momentum fraction
+   * @param x2 second momentum fraction
+   * @param q2 scale
+   * @param order order index
+   * @param observable observable value
+   * @param lumi luminosity index
+   * @param weight weight
+   */
+  void fill(const double x1, const double x2, const double q2,
+            const std::size_t order, const double observable,
+            const std::size_t lumi, const double weight) const {
+    pineappl_incremental_optimizer_fill(this->raw, x1, x2, q2, order,
+                                        observable, lumi, weight);
+  }
+
+  /** @brief Immediately compact all subgrids not filled since the last
+   * compaction, e.g. to enforce a memory budget. */
+  void compact() const { pineappl_incremental_optimizer_compact(this->raw); }
 };
 
 } // namespace PineAPPL
@@ -59,15 +59,20 @@ use itertools::izip;
 use pineappl::bin::BinRemapper;
 use pineappl::boc::{Channel, Order};
 use pineappl::convolutions::LumiCache;
-use pineappl::grid::{Grid, GridOptFlags, Ntuple};
-use pineappl::subgrid::{ExtraSubgridParams, SubgridParams};
-use std::collections::HashMap;
+use pineappl::empty_subgrid::EmptySubgridV1;
+use pineappl::grid::{ConvolvePlan, Grid, GridFooter, GridOptFlags, Ntuple, PdfNodeTable};
+use pineappl::pids::{self, charge_conjugate_pdg_pid, PidBasis};
+use pineappl::subgrid::{ExtraSubgridParams, Mu2, Subgrid, SubgridParams};
+use std::collections::{HashMap, HashSet};
 use std::ffi::{CStr, CString};
 use std::fs::File;
+use std::iter;
 use std::mem;
 use std::os::raw::{c_char, c_void};
 use std::path::Path;
+use std::ptr;
 use std::slice;
+use std::thread;
 
 // TODO: make sure no `panic` calls leave functions marked as `extern "C"`
 
@@ -109,6 +114,10 @@ fn grid_params(key_vals: Option<&KeyVal>) -> (String, SubgridParams, ExtraSubgri
             subgrid_params.set_q2_order(usize::try_from(*value).unwrap());
         }
 
+        if let Some(value) = keyval.bools.get("allocate_upfront") {
+            subgrid_params.set_allocate_upfront(*value);
+        }
+
         if let Some(value) = keyval.bools.get("reweight") {
             subgrid_params.set_reweight(*value);
         }
@@ -421,6 +430,755 @@ pub unsafe extern "C" fn pineappl_grid_convolve_with_one(
     ));
 }
 
+/// Compile a convolution plan for `grid` that captures the subgrid traversal order and the
+/// per-channel PDF combinations after applying `order_mask` and `channel_mask`, which have the
+/// same meaning as in `pineappl_grid_convolve_with_one`. The plan can be executed for many scale
+/// settings at once with `pineappl_grid_convolve_with_plan` without redoing this work for every
+/// `(xi_ren, xi_fac)` point; it must be recompiled after `grid` has been modified. The plan must
+/// be deleted with `pineappl_convolve_plan_delete`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The parameters `order_mask` and `channel_mask` must either
+/// be null pointers or point to arrays that are as long as `grid` has orders and channels,
+/// respectively.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_convolve_plan_new(
+    grid: *const Grid,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+) -> Box<ConvolvePlan> {
+    let grid = unsafe { &*grid };
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_owned()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+
+    Box::new(grid.convolve_plan(&order_mask, &[], &channel_mask))
+}
+
+/// Convolutes `grid` with the PDF `xfx` like `pineappl_grid_convolve_with_one`, but executes the
+/// precompiled `plan` for all `points` scale settings given in `xi_ren` and `xi_fac` in a single
+/// pass over the subgrids, so that each subgrid is read only once instead of once per point. This
+/// is the preferred way to perform the customary 7-point scale variation. The predictions are
+/// written into `results`, with the `points` values of each bin stored consecutively.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null
+/// pointer, this function is not safe to call. The parameter `plan` must point to a valid
+/// `pineappl_convolve_plan` compiled from `grid` by `pineappl_grid_convolve_plan_new`. The
+/// function pointers `xfx` and `alphas` must not be null pointers and point to valid functions.
+/// The parameters `xi_ren` and `xi_fac` must point to arrays with `points` entries and `results`
+/// must be as long as `grid` has bins, multiplied with `points`.
+///
+/// # Panics
+///
+/// Panics if `plan` was compiled from a grid with different dimensions than `grid`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_plan(
+    grid: *const Grid,
+    plan: *const ConvolvePlan,
+    pdg_id: i32,
+    xfx: extern "C" fn(pdg_id: i32, x: f64, q2: f64, state: *mut c_void) -> f64,
+    alphas: extern "C" fn(q2: f64, state: *mut c_void) -> f64,
+    state: *mut c_void,
+    xi_ren: *const f64,
+    xi_fac: *const f64,
+    points: usize,
+    results: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+    let plan = unsafe { &*plan };
+    let mut pdf = |id, x, q2| xfx(id, x, q2, state);
+    let mut als = |q2| alphas(q2, state);
+    let xi_ren = unsafe { slice::from_raw_parts(xi_ren, points) };
+    let xi_fac = unsafe { slice::from_raw_parts(xi_fac, points) };
+    let xi: Vec<_> = xi_ren
+        .iter()
+        .zip(xi_fac)
+        .map(|(&xir, &xif)| (xir, xif))
+        .collect();
+    let results = unsafe { slice::from_raw_parts_mut(results, grid.bin_info().bins() * points) };
+    let mut lumi_cache = LumiCache::with_one(pdg_id, &mut pdf, &mut als);
+
+    results.copy_from_slice(&grid.convolve_with_plan(plan, &mut lumi_cache, &xi));
+}
+
+/// Deletes a convolution plan created with `pineappl_grid_convolve_plan_new`.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_convolve_plan_delete(plan: Option<Box<ConvolvePlan>>) {}
+
+/// Extract the interpolation nodes of `grid` into a newly allocated PDF node table. The caller
+/// queries the node lists with `pineappl_pdf_table_pids`, `pineappl_pdf_table_x`,
+/// `pineappl_pdf_table_muf2` and `pineappl_pdf_table_mur2`, fills the arrays returned by
+/// `pineappl_pdf_table_values` and `pineappl_pdf_table_alphas` with its own (possibly vectorized)
+/// PDF evaluation, and then runs `pineappl_grid_convolve_with_table`, which performs no PDF
+/// callbacks at all. The node lists correspond to the central scales; the table must be rebuilt
+/// after `grid` has been modified and deleted with `pineappl_pdf_table_delete`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_pdf_table_new(grid: *const Grid) -> Box<PdfNodeTable> {
+    let grid = unsafe { &*grid };
+
+    Box::new(grid.pdf_node_table())
+}
+
+/// Return the number of PDG ids for which PDF values must be supplied to `table`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_pid_count(table: *const PdfNodeTable) -> usize {
+    let table = unsafe { &*table };
+
+    table.pids().len()
+}
+
+/// Write the PDG ids for which PDF values must be supplied to `table` into `pids`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new` and `pids` must point to an array as long as
+/// `pineappl_pdf_table_pid_count` returns.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_pdf_table_pids(table: *const PdfNodeTable, pids: *mut i32) {
+    let table = unsafe { &*table };
+    let pids = unsafe { slice::from_raw_parts_mut(pids, table.pids().len()) };
+
+    pids.copy_from_slice(table.pids());
+}
+
+/// Return the number of unique momentum fractions of the interpolation nodes in `table`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_x_count(table: *const PdfNodeTable) -> usize {
+    let table = unsafe { &*table };
+
+    table.x().len()
+}
+
+/// Write the unique momentum fractions of the interpolation nodes in `table` into `x`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new` and `x` must point to an array as long as
+/// `pineappl_pdf_table_x_count` returns.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_pdf_table_x(table: *const PdfNodeTable, x: *mut f64) {
+    let table = unsafe { &*table };
+    let x = unsafe { slice::from_raw_parts_mut(x, table.x().len()) };
+
+    x.copy_from_slice(table.x());
+}
+
+/// Return the number of unique factorization scales of the interpolation nodes in `table`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_muf2_count(table: *const PdfNodeTable) -> usize {
+    let table = unsafe { &*table };
+
+    table.muf2().len()
+}
+
+/// Write the unique factorization scales of the interpolation nodes in `table` into `muf2`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new` and `muf2` must point to an array as long as
+/// `pineappl_pdf_table_muf2_count` returns.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_pdf_table_muf2(table: *const PdfNodeTable, muf2: *mut f64) {
+    let table = unsafe { &*table };
+    let muf2 = unsafe { slice::from_raw_parts_mut(muf2, table.muf2().len()) };
+
+    muf2.copy_from_slice(table.muf2());
+}
+
+/// Return the number of unique renormalization scales of the interpolation nodes in `table`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_mur2_count(table: *const PdfNodeTable) -> usize {
+    let table = unsafe { &*table };
+
+    table.mur2().len()
+}
+
+/// Write the unique renormalization scales of the interpolation nodes in `table` into `mur2`.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new` and `mur2` must point to an array as long as
+/// `pineappl_pdf_table_mur2_count` returns.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_pdf_table_mur2(table: *const PdfNodeTable, mur2: *mut f64) {
+    let table = unsafe { &*table };
+    let mur2 = unsafe { slice::from_raw_parts_mut(mur2, table.mur2().len()) };
+
+    mur2.copy_from_slice(table.mur2());
+}
+
+/// Return a mutable pointer to the PDF values of `table`, which the caller must fill before the
+/// convolution. The array has `pid_count * muf2_count * x_count` entries and the value for the
+/// parton `pids[ipid]` at `x[ix]` and `muf2[imuf2]` — multiplied with `x`, as usual — is stored
+/// at the index `(ipid * muf2_count + imuf2) * x_count + ix`. The pointer stays valid until the
+/// table is deleted.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_values(table: *mut PdfNodeTable) -> *mut f64 {
+    let table = unsafe { &mut *table };
+
+    table.values_mut().as_mut_ptr()
+}
+
+/// Return a mutable pointer to the strong-coupling values of `table`, which the caller must fill
+/// before the convolution. The array has `mur2_count` entries and the entry at index `imur2`
+/// corresponds to the scale `mur2[imur2]`. The pointer stays valid until the table is deleted.
+///
+/// # Safety
+///
+/// The parameter `table` must point to a valid `pineappl_pdf_table` object created by
+/// `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_pdf_table_alphas(table: *mut PdfNodeTable) -> *mut f64 {
+    let table = unsafe { &mut *table };
+
+    table.alphas_mut().as_mut_ptr()
+}
+
+/// Convolutes `grid` with the PDF values stored in `table` instead of callbacks; the luminosity
+/// becomes a pure lookup-and-multiply over the dense table, which is the fastest way to
+/// repeatedly convolve the same grid with changing PDFs. The parameters `order_mask` and
+/// `channel_mask` have the same meaning as in `pineappl_grid_convolve_with_one`. Only the central
+/// scales are evaluated, so orders with scale logarithms do not contribute. The differential
+/// cross section for each bin is written into `results`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null
+/// pointer, this function is not safe to call. The parameter `table` must point to a valid
+/// `pineappl_pdf_table` built from the current state of `grid`. The parameters `order_mask` and
+/// `channel_mask` must either be null pointers or point to arrays that are as long as `grid` has
+/// orders and channels, respectively. Finally, `results` must be as long as `grid` has bins.
+///
+/// # Panics
+///
+/// Panics if `table` was not built from the current state of `grid`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_table(
+    grid: *const Grid,
+    table: *const PdfNodeTable,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+    results: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+    let table = unsafe { &*table };
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_owned()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+    let results = unsafe { slice::from_raw_parts_mut(results, grid.bin_info().bins()) };
+
+    results.copy_from_slice(&grid.convolve_with_table(table, &order_mask, &[], &channel_mask));
+}
+
+/// Deletes a PDF node table created with `pineappl_grid_pdf_table_new`.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_pdf_table_delete(table: Option<Box<PdfNodeTable>>) {}
+
+/// Convolutes the specified grid with a PDF using `threads` worker threads. The bins of the grid
+/// are partitioned across the threads, and each thread performs an independent convolution of its
+/// share of the bins. The callbacks `xfx` and `alphas` have the same meaning as in
+/// [`pineappl_grid_convolve_with_one`], but are called with one of the `threads` state pointers
+/// from `states` — thread `i` only ever uses `states[i]`, so no callback state is shared between
+/// threads and one LHAPDF object per thread suffices. The predictions for all bins are written
+/// into `results`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The function pointers `xfx` and `alphas` must not be null
+/// pointers and point to valid functions that may be called from any thread. The parameter
+/// `states` must point to an array with `threads` state pointers that belong to independent
+/// objects. The parameters `order_mask` and `channel_mask` must either be null pointers or point
+/// to arrays that are as long as `grid` has orders and channels, respectively. Finally, `results`
+/// must be as long as `grid` has bins.
+///
+/// # Panics
+///
+/// Panics if `threads` is zero.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_one_threaded(
+    grid: *const Grid,
+    pdg_id: i32,
+    xfx: extern "C" fn(pdg_id: i32, x: f64, q2: f64, state: *mut c_void) -> f64,
+    alphas: extern "C" fn(q2: f64, state: *mut c_void) -> f64,
+    states: *const *mut c_void,
+    threads: usize,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+    xi_ren: f64,
+    xi_fac: f64,
+    results: *mut f64,
+) {
+    assert_ne!(threads, 0);
+
+    let grid = unsafe { &*grid };
+    let states = unsafe { slice::from_raw_parts(states, threads) };
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_vec()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+    let bins = grid.bin_info().bins();
+    let results = unsafe { slice::from_raw_parts_mut(results, bins) };
+
+    if bins == 0 {
+        return;
+    }
+
+    let order_mask = order_mask.as_slice();
+    let channel_mask = channel_mask.as_slice();
+
+    // partition the bins into as many contiguous chunks as there are threads; `usize::div_ceil`
+    // is only available from Rust 1.73 on
+    let chunk_size = (bins + threads - 1) / threads;
+    let bin_indices: Vec<Vec<usize>> = (0..bins)
+        .collect::<Vec<_>>()
+        .chunks(chunk_size)
+        .map(<[usize]>::to_vec)
+        .collect();
+
+    thread::scope(|scope| {
+        for (chunk, (indices, &state)) in results
+            .chunks_mut(chunk_size)
+            .zip(bin_indices.iter().zip(states))
+        {
+            // pointers aren't `Send`, but each thread only uses its own state
+            let state = state as usize;
+
+            scope.spawn(move || {
+                let state = state as *mut c_void;
+                let mut pdf = |id, x, q2| xfx(id, x, q2, state);
+                let mut als = |q2| alphas(q2, state);
+                let mut lumi_cache = LumiCache::with_one(pdg_id, &mut pdf, &mut als);
+
+                chunk.copy_from_slice(&grid.convolve(
+                    &mut lumi_cache,
+                    order_mask,
+                    indices,
+                    channel_mask,
+                    &[(xi_ren, xi_fac)],
+                ));
+            });
+        }
+    });
+}
+
+/// Convolutes the specified grid with a PDF given by the batched callback `xfx_batched`. This
+/// function computes the same results as [`pineappl_grid_convolve_with_one`], but instead of
+/// calling the PDF once per (parton, `x`, `q2`) node it collects the distinct `x` and `q2` values
+/// of all subgrids first and then hands whole arrays to `xfx_batched` — one call per parton ID.
+/// The callback must write the PDF values, multiplied with their argument `x`, for all `size`
+/// nodes `(x[i], q2[i])` into `results`. This allows the PDF interpolation to run in a
+/// cache-friendly, vectorizable loop, which is much faster than one virtual call per node. All
+/// remaining parameters have the same meaning as in [`pineappl_grid_convolve_with_one`].
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The function pointers `xfx_batched` and `alphas` must not be
+/// null pointers and point to valid functions. The parameters `order_mask` and `channel_mask`
+/// must either be null pointers or point to arrays that are as long as `grid` has orders and
+/// channels, respectively. Finally, `results` must be as long as `grid` has bins.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_one_batched(
+    grid: *const Grid,
+    pdg_id: i32,
+    xfx_batched: extern "C" fn(
+        pdg_id: i32,
+        x: *const f64,
+        q2: *const f64,
+        size: usize,
+        results: *mut f64,
+        state: *mut c_void,
+    ),
+    alphas: extern "C" fn(q2: f64, state: *mut c_void) -> f64,
+    state: *mut c_void,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+    xi_ren: f64,
+    xi_fac: f64,
+    results: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+
+    // collect the distinct x and muf2 values of all non-empty subgrids; this mirrors what
+    // `LumiCache::setup` does internally, so the per-node lookups below never miss
+    let mut x_grid: Vec<f64> = grid
+        .subgrids()
+        .iter()
+        .filter(|subgrid| !subgrid.is_empty())
+        .flat_map(|subgrid| {
+            let mut vec = subgrid.x1_grid().into_owned();
+            vec.extend_from_slice(&subgrid.x2_grid());
+            vec
+        })
+        .collect();
+    x_grid.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+    x_grid.dedup();
+
+    let mut muf2_grid: Vec<f64> = grid
+        .subgrids()
+        .iter()
+        .filter(|subgrid| !subgrid.is_empty())
+        .flat_map(|subgrid| {
+            subgrid
+                .mu2_grid()
+                .iter()
+                .map(|Mu2 { fac, .. }| xi_fac * xi_fac * fac)
+                .collect::<Vec<_>>()
+        })
+        .collect();
+    muf2_grid.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+    muf2_grid.dedup();
+
+    // partons the convolution will ask for: all PIDs appearing in the channels and their charge
+    // conjugates, since the latter are substituted depending on the grid's convolutions; the
+    // convolution translates the channels into the PDG basis first, so do the same here
+    let channels: Vec<Channel> = match grid.pid_basis() {
+        PidBasis::Evol => grid
+            .channels()
+            .iter()
+            .map(|entry| Channel::translate(entry, &pids::evol_to_pdg_mc_ids))
+            .collect(),
+        PidBasis::Pdg => grid.channels().to_vec(),
+    };
+    let mut pids: Vec<i32> = channels
+        .iter()
+        .flat_map(Channel::entry)
+        .flat_map(|&(a, b, _)| {
+            [
+                a,
+                b,
+                charge_conjugate_pdg_pid(a),
+                charge_conjugate_pdg_pid(b),
+            ]
+        })
+        .collect();
+    pids.sort_unstable();
+    pids.dedup();
+
+    // evaluate the PDF once per parton for the entire (x, muf2) lattice
+    let x_batch: Vec<f64> = x_grid
+        .iter()
+        .flat_map(|&x| iter::repeat(x).take(muf2_grid.len()))
+        .collect();
+    let q2_batch: Vec<f64> = muf2_grid
+        .iter()
+        .copied()
+        .cycle()
+        .take(x_grid.len() * muf2_grid.len())
+        .collect();
+    let table: HashMap<i32, Vec<f64>> = pids
+        .iter()
+        .map(|&pid| {
+            let mut values = vec![0.0; x_batch.len()];
+            xfx_batched(
+                pid,
+                x_batch.as_ptr(),
+                q2_batch.as_ptr(),
+                x_batch.len(),
+                values.as_mut_ptr(),
+                state,
+            );
+            (pid, values)
+        })
+        .collect();
+
+    let mut pdf = |id: i32, x: f64, q2: f64| {
+        let ix = x_grid
+            .iter()
+            .position(|&value| value == x)
+            .unwrap_or_else(|| unreachable!());
+        let iq2 = muf2_grid
+            .iter()
+            .position(|&value| value == q2)
+            .unwrap_or_else(|| unreachable!());
+        table[&id][ix * muf2_grid.len() + iq2]
+    };
+    let mut als = |q2| alphas(q2, state);
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_vec()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+    let results = unsafe { slice::from_raw_parts_mut(results, grid.bin_info().bins()) };
+    let mut lumi_cache = LumiCache::with_one(pdg_id, &mut pdf, &mut als);
+
+    results.copy_from_slice(&grid.convolve(
+        &mut lumi_cache,
+        &order_mask,
+        &[],
+        &channel_mask,
+        &[(xi_ren, xi_fac)],
+    ));
+}
+
+/// Convolutes the specified grid with several PDFs — typically all members of a PDF set — in a
+/// single pass over the grid. The callbacks `xfx` and `alphas` have the same meaning as in
+/// [`pineappl_grid_convolve_with_one`], but are called with one of the `members` state pointers
+/// from `states`, one per PDF member. The subgrid traversal, mask checks, and channel resolution
+/// are shared by all members, which makes this considerably faster than calling
+/// [`pineappl_grid_convolve_with_one`] once per member. The results are written member-by-member
+/// into `results`: the first `bin_count` elements contain the predictions of the first member,
+/// and so on.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The function pointers `xfx` and `alphas` must not be null
+/// pointers and point to valid functions. The parameter `states` must point to an array with
+/// `members` state pointers. The parameters `order_mask` and `channel_mask` must either be null
+/// pointers or point to arrays that are as long as `grid` has orders and channels, respectively.
+/// Finally, `results` must be as long as `members` times the number of bins of `grid`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_one_multi(
+    grid: *const Grid,
+    pdg_id: i32,
+    xfx: extern "C" fn(pdg_id: i32, x: f64, q2: f64, state: *mut c_void) -> f64,
+    alphas: extern "C" fn(q2: f64, state: *mut c_void) -> f64,
+    states: *const *mut c_void,
+    members: usize,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+    xi_ren: f64,
+    xi_fac: f64,
+    results: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+    let states = unsafe { slice::from_raw_parts(states, members) };
+    let mut pdfs: Vec<_> = states
+        .iter()
+        .map(|&state| move |id, x, q2| xfx(id, x, q2, state))
+        .collect();
+    let mut alphass: Vec<_> = states
+        .iter()
+        .map(|&state| move |q2| alphas(q2, state))
+        .collect();
+    let mut lumi_caches: Vec<_> = pdfs
+        .iter_mut()
+        .zip(alphass.iter_mut())
+        .map(|(pdf, als)| LumiCache::with_one(pdg_id, pdf, als))
+        .collect();
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_vec()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+    let results =
+        unsafe { slice::from_raw_parts_mut(results, members * grid.bin_info().bins()) };
+
+    results.copy_from_slice(&grid.convolve_multi(
+        &mut lumi_caches,
+        &order_mask,
+        &[],
+        &channel_mask,
+        &[(xi_ren, xi_fac)],
+    ));
+}
+
+fn grid_mur2_nodes(grid: &Grid, xi_ren: f64) -> Vec<f64> {
+    let mut mur2_grid: Vec<f64> = grid
+        .subgrids()
+        .iter()
+        .filter(|subgrid| !subgrid.is_empty())
+        .flat_map(|subgrid| {
+            subgrid
+                .mu2_grid()
+                .iter()
+                .map(|Mu2 { ren, .. }| xi_ren * xi_ren * ren)
+                .collect::<Vec<_>>()
+        })
+        .collect();
+    mur2_grid.sort_by(|a, b| a.partial_cmp(b).unwrap_or_else(|| unreachable!()));
+    mur2_grid.dedup();
+
+    mur2_grid
+}
+
+/// Returns the number of distinct renormalization scales of `grid` for the scale variation
+/// `xi_ren`. See [`pineappl_grid_mur2_nodes`].
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_mur2_nodes_count(grid: *const Grid, xi_ren: f64) -> usize {
+    let grid = unsafe { &*grid };
+
+    grid_mur2_nodes(grid, xi_ren).len()
+}
+
+/// Writes the distinct renormalization scales of `grid` for the scale variation `xi_ren` into
+/// `mur2`, in ascending order. These are exactly the scales at which a convolution with the same
+/// `xi_ren` evaluates the strong coupling, so the caller can solve the running coupling once per
+/// node and pass the values as a table to
+/// [`pineappl_grid_convolve_with_one_alphas_table`] — instead of recomputing them through the
+/// `alphas` callback for every convolution.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The parameter `mur2` must point to an array that is as long
+/// as the value returned by [`pineappl_grid_mur2_nodes_count`].
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_mur2_nodes(
+    grid: *const Grid,
+    xi_ren: f64,
+    mur2: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+    let nodes = grid_mur2_nodes(grid, xi_ren);
+    let mur2 = unsafe { slice::from_raw_parts_mut(mur2, nodes.len()) };
+
+    mur2.copy_from_slice(&nodes);
+}
+
+/// Convolutes the specified grid with the PDF `xfx`, taking the strong coupling from a
+/// precomputed table instead of a callback. The parameters `mur2` and `alphas_table` must be
+/// arrays of length `size` containing the scales returned by [`pineappl_grid_mur2_nodes`] for the
+/// same value of `xi_ren` and the corresponding values of the strong coupling. All remaining
+/// parameters have the same meaning as in [`pineappl_grid_convolve_with_one`].
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The function pointer `xfx` must not be a null pointer and
+/// point to a valid function. The parameters `mur2` and `alphas_table` must point to arrays of
+/// length `size`. The parameters `order_mask` and `channel_mask` must either be null pointers or
+/// point to arrays that are as long as `grid` has orders and channels, respectively. Finally,
+/// `results` must be as long as `grid` has bins.
+///
+/// # Panics
+///
+/// Panics if the convolution evaluates the strong coupling at a scale that is not contained in
+/// `mur2`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_convolve_with_one_alphas_table(
+    grid: *const Grid,
+    pdg_id: i32,
+    xfx: extern "C" fn(pdg_id: i32, x: f64, q2: f64, state: *mut c_void) -> f64,
+    state: *mut c_void,
+    mur2: *const f64,
+    alphas_table: *const f64,
+    size: usize,
+    order_mask: *const bool,
+    channel_mask: *const bool,
+    xi_ren: f64,
+    xi_fac: f64,
+    results: *mut f64,
+) {
+    let grid = unsafe { &*grid };
+    let mur2 = unsafe { slice::from_raw_parts(mur2, size) };
+    let alphas_table = unsafe { slice::from_raw_parts(alphas_table, size) };
+    let mut pdf = |id, x, q2| xfx(id, x, q2, state);
+    let mut als = |q2: f64| {
+        let index = mur2
+            .iter()
+            .position(|&value| value == q2)
+            .unwrap_or_else(|| panic!("alphas table does not contain the scale {q2}"));
+        alphas_table[index]
+    };
+    let order_mask = if order_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(order_mask, grid.orders().len()) }.to_vec()
+    };
+    let channel_mask = if channel_mask.is_null() {
+        vec![]
+    } else {
+        unsafe { slice::from_raw_parts(channel_mask, grid.channels().len()) }.to_vec()
+    };
+    let results = unsafe { slice::from_raw_parts_mut(results, grid.bin_info().bins()) };
+    let mut lumi_cache = LumiCache::with_one(pdg_id, &mut pdf, &mut als);
+
+    results.copy_from_slice(&grid.convolve(
+        &mut lumi_cache,
+        &order_mask,
+        &[],
+        &channel_mask,
+        &[(xi_ren, xi_fac)],
+    ));
+}
+
 /// Convolutes the specified grid with the PDFs `xfx1` and `xfx2`, which are the PDFs of hadrons
 /// with PDG ids `pdg_id1` and `pdg_id2`, respectively, and strong coupling `alphas`. These
 /// functions must evaluate the PDFs for the given `x` and `q2` for the parton with the given PDG
@@ -483,6 +1241,28 @@ pub unsafe extern "C" fn pineappl_grid_convolve_with_two(
     ));
 }
 
+/// Returns a cloned object of `grid` in which all subgrids are empty. The clone shares the
+/// channels, orders, bin limits, and key-value storage of `grid` and can therefore always be
+/// merged back into `grid` using [`pineappl_grid_merge_and_delete`]. This is useful for filling a
+/// single grid from multiple threads: create one clone per thread, fill the clones concurrently —
+/// each clone is only accessed by its own thread — and finally merge them into the original grid.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_clone_empty(grid: *const Grid) -> Box<Grid> {
+    let grid = unsafe { &*grid };
+    let mut clone = grid.clone();
+
+    for subgrid in clone.subgrids_mut() {
+        *subgrid = EmptySubgridV1.into();
+    }
+
+    Box::new(clone)
+}
+
 /// Try to deduplicate channels of `grid` by detecting pairs of them that contain the same
 /// subgrids. The numerical equality is tested using a tolerance of `ulps`, given in [units of
 /// least precision](https://docs.rs/float-cmp/latest/float_cmp/index.html#some-explanation).
@@ -588,13 +1368,192 @@ pub unsafe extern "C" fn pineappl_grid_fill_array(
     let lumis = unsafe { slice::from_raw_parts(lumis, size) };
     let weights = unsafe { slice::from_raw_parts(weights, size) };
 
-    for (&x1, &x2, &q2, &order, &observable, &lumi, &weight) in
-        izip!(x1, x2, q2, orders, observables, lumis, weights)
-    {
-        grid.fill(order, observable, lumi, &Ntuple { x1, x2, q2, weight });
+    for (&x1, &x2, &q2, &order, &observable, &lumi, &weight) in
+        izip!(x1, x2, q2, orders, observables, lumis, weights)
+    {
+        grid.fill(order, observable, lumi, &Ntuple { x1, x2, q2, weight });
+    }
+}
+
+/// Token for the unchecked fast-path fill of a fixed `(order, lumi)` pair. See
+/// `pineappl_grid_fill_token`.
+pub struct FillToken {
+    grid: *mut Grid,
+    order: usize,
+    lumi: usize,
+}
+
+/// Validates `order` and `lumi` for `grid` once and returns a token with which
+/// `pineappl_grid_fill_unchecked` fills the grid without any per-event checks. This is faster than
+/// `pineappl_grid_fill` in generator inner loops where the order and luminosity index are
+/// loop-invariant. The token must be deleted with `pineappl_fill_token_delete`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The token borrows `grid`: it must not be used after the grid
+/// has been deleted or structurally modified, for example by merging bins.
+///
+/// # Panics
+///
+/// Panics if `order` or `lumi` are out of range.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_fill_token(
+    grid: *mut Grid,
+    order: usize,
+    lumi: usize,
+) -> Box<FillToken> {
+    let grid_ref = unsafe { &mut *grid };
+    grid_ref.prepare_fill(order, lumi);
+
+    Box::new(FillToken { grid, order, lumi })
+}
+
+/// Fill the grid that `token` was created for with the momentum fractions `x1` and `x2`, at the
+/// scale `q2` for the given value of the `observable` with `weight`, using the order and
+/// luminosity index validated when the token was created. No per-event checks are performed.
+///
+/// # Safety
+///
+/// The parameter `token` must point to a valid `FillToken` object created by
+/// `pineappl_grid_fill_token`, and the grid it was created for must still be alive.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_fill_unchecked(
+    token: *mut FillToken,
+    x1: f64,
+    x2: f64,
+    q2: f64,
+    observable: f64,
+    weight: f64,
+) {
+    let token = unsafe { &mut *token };
+    let grid = unsafe { &mut *token.grid };
+
+    grid.fill_unchecked(
+        token.order,
+        token.lumi,
+        observable,
+        &Ntuple { x1, x2, q2, weight },
+    );
+}
+
+/// Delete a fill token previously created with `pineappl_grid_fill_token`. The grid the token was
+/// created for is not deleted.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_fill_token_delete(token: Option<Box<FillToken>>) {}
+
+/// Compacts cold subgrids while a grid is being filled. See
+/// `pineappl_incremental_optimizer_new`.
+pub struct IncrementalOptimizer {
+    grid: *mut Grid,
+    interval: usize,
+    fills: usize,
+    filled: HashSet<(usize, usize, usize)>,
+}
+
+impl IncrementalOptimizer {
+    fn compact(&mut self) {
+        let grid = unsafe { &mut *self.grid };
+        let filled = mem::take(&mut self.filled);
+
+        grid.compact_subgrids(|order, bin, channel| !filled.contains(&(order, bin, channel)));
+        self.fills = 0;
+    }
+}
+
+/// Creates an incremental optimizer for `grid`. Every `interval` calls of
+/// `pineappl_incremental_optimizer_fill` the optimizer compacts all subgrids that were not filled
+/// during the last interval, which keeps the resident size of a long fill run close to the
+/// footprint of the optimized grid instead of letting sparse, unpruned subgrids accumulate until
+/// `pineappl_grid_optimize` runs. If `interval` is zero, subgrids are only compacted when
+/// `pineappl_incremental_optimizer_compact` is called, which is useful when compaction should be
+/// triggered by a memory budget that the caller monitors itself. The optimizer must be deleted
+/// with `pineappl_incremental_optimizer_delete`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The optimizer borrows `grid`: it must not be used after the
+/// grid has been deleted.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_incremental_optimizer_new(
+    grid: *mut Grid,
+    interval: usize,
+) -> Box<IncrementalOptimizer> {
+    Box::new(IncrementalOptimizer {
+        grid,
+        interval,
+        fills: 0,
+        filled: HashSet::new(),
+    })
+}
+
+/// Fill the grid behind `optimizer` like `pineappl_grid_fill` and compact cold subgrids whenever
+/// the configured interval of fills has passed. Events that hit a previously compacted subgrid are
+/// merged into it, so no fills are lost; such fills are slower, which is why only subgrids that
+/// were not filled during the last interval are compacted.
+///
+/// # Safety
+///
+/// The parameter `optimizer` must point to a valid `IncrementalOptimizer` object created by
+/// `pineappl_incremental_optimizer_new`, and the grid it was created for must still be alive.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_incremental_optimizer_fill(
+    optimizer: *mut IncrementalOptimizer,
+    x1: f64,
+    x2: f64,
+    q2: f64,
+    order: usize,
+    observable: f64,
+    lumi: usize,
+    weight: f64,
+) {
+    let optimizer = unsafe { &mut *optimizer };
+    let grid = unsafe { &mut *optimizer.grid };
+
+    if let Some(bin) = grid.bin_index(observable) {
+        optimizer.filled.insert((order, bin, lumi));
+    }
+
+    grid.fill(order, observable, lumi, &Ntuple { x1, x2, q2, weight });
+
+    if optimizer.interval > 0 {
+        optimizer.fills += 1;
+
+        if optimizer.fills >= optimizer.interval {
+            optimizer.compact();
+        }
     }
 }
 
+/// Immediately compact all subgrids that were not filled since the last compaction. This can be
+/// used to enforce a memory budget independently of the fill interval.
+///
+/// # Safety
+///
+/// The parameter `optimizer` must point to a valid `IncrementalOptimizer` object created by
+/// `pineappl_incremental_optimizer_new`, and the grid it was created for must still be alive.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_incremental_optimizer_compact(
+    optimizer: *mut IncrementalOptimizer,
+) {
+    let optimizer = unsafe { &mut *optimizer };
+
+    optimizer.compact();
+}
+
+/// Delete an incremental optimizer previously created with `pineappl_incremental_optimizer_new`.
+/// The grid the optimizer was created for is not deleted.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_incremental_optimizer_delete(
+    optimizer: Option<Box<IncrementalOptimizer>>,
+) {
+}
+
 /// Return the luminosity function of `grid`.
 ///
 /// # Safety
@@ -643,6 +1602,43 @@ pub unsafe extern "C" fn pineappl_grid_order_count(grid: *const Grid) -> usize {
     grid.orders().len()
 }
 
+/// Snapshot of the instrumentation counters of a grid; see `pineappl_grid_stats`.
+#[repr(C)]
+pub struct Stats {
+    /// Number of events passed to the fill functions.
+    pub fill_calls: u64,
+    /// Number of fill calls whose observable fell outside of the bin limits.
+    pub bin_search_misses: u64,
+    /// Number of subgrids instantiated from the subgrid template while filling.
+    pub subgrid_allocations: u64,
+    /// Number of PDF callback invocations performed during convolutions; lookups answered by the
+    /// PDF cache are not counted.
+    pub pdf_evaluations: u64,
+    /// Number of subgrid nodes evaluated during convolutions.
+    pub convolve_nodes: u64,
+}
+
+/// Read the instrumentation counters of `grid` into `stats`. The counters are always enabled;
+/// they are updated with relaxed atomic increments, start at zero for every newly created or
+/// read grid and are not written to grid files.
+///
+/// # Safety
+///
+/// The parameter `grid` must point to a valid `Grid` object created by `pineappl_grid_new` or
+/// `pineappl_grid_read` and `stats` must point to a writable `pineappl_stats` object.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_stats(grid: *const Grid, stats: *mut Stats) {
+    let grid = unsafe { &*grid };
+    let stats = unsafe { &mut *stats };
+    let counters = grid.stats();
+
+    stats.fill_calls = counters.fill_calls();
+    stats.bin_search_misses = counters.bin_search_misses();
+    stats.subgrid_allocations = counters.subgrid_allocations();
+    stats.pdf_evaluations = counters.pdf_evaluations();
+    stats.convolve_nodes = counters.convolve_nodes();
+}
+
 /// Creates a new and empty grid. The creation requires four different sets of parameters:
 /// - The luminosity function `lumi`: A pointer to the luminosity function that specifies how the
 ///   cross section should be reconstructed.
@@ -736,6 +1732,216 @@ pub unsafe extern "C" fn pineappl_grid_read(filename: *const c_char) -> Box<Grid
     Box::new(Grid::read(reader).unwrap())
 }
 
+/// Type for a grid that is read from disk only when it is first accessed.
+pub struct LazyGrid {
+    filename: String,
+    grid: Option<Grid>,
+}
+
+/// Opens the file with name `filename` for lazy reading. In contrast to `pineappl_grid_read` this
+/// function only checks that the file can be opened; the expensive decompression and
+/// deserialization of the grid is deferred to the first call of `pineappl_lazy_grid_grid`. This is
+/// useful when a program opens many grids but accesses only a few of them.
+///
+/// # Safety
+///
+/// The parameter `filename` must be a C string pointing to an existing grid file.
+///
+/// # Panics
+///
+/// Panics if the file cannot be opened.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_open_lazy(filename: *const c_char) -> Box<LazyGrid> {
+    let filename = unsafe { CStr::from_ptr(filename) };
+    let filename = filename.to_string_lossy().into_owned();
+
+    // fail early if the file is missing or unreadable, but do not read its contents yet
+    File::open(&filename).unwrap();
+
+    Box::new(LazyGrid {
+        filename,
+        grid: None,
+    })
+}
+
+/// Returns the grid stored in the file that `lazy_grid` was opened with. The file is read on the
+/// first call; all further calls return the cached grid. The returned pointer is owned by
+/// `lazy_grid` and must not be deleted; it stays valid until `pineappl_lazy_grid_delete` is
+/// called.
+///
+/// # Safety
+///
+/// The parameter `lazy_grid` must point to a valid `LazyGrid` object created by
+/// `pineappl_grid_open_lazy`.
+///
+/// # Panics
+///
+/// Panics if the file cannot be read or does not contain a valid grid.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_lazy_grid_grid(lazy_grid: *mut LazyGrid) -> *mut Grid {
+    let lazy_grid = unsafe { &mut *lazy_grid };
+
+    if lazy_grid.grid.is_none() {
+        let reader = File::open(&lazy_grid.filename).unwrap();
+        lazy_grid.grid = Some(Grid::read(reader).unwrap());
+    }
+
+    // UNWRAP: the grid has just been read if it wasn't present before
+    lazy_grid.grid.as_mut().unwrap()
+}
+
+/// Delete a lazy grid previously created with `pineappl_grid_open_lazy`, together with the grid it
+/// may have read.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_lazy_grid_delete(lazy_grid: Option<Box<LazyGrid>>) {}
+
+/// Read only the metadata footer of the grid file with name `filename`. The footer stores the
+/// orders, channels, bin limits and key-value pairs of the grid and is found with a seek to the
+/// end of the file, so in contrast to `pineappl_grid_read` the subgrid data is neither
+/// decompressed nor deserialized. The returned object must be deleted with
+/// `pineappl_grid_footer_delete`.
+///
+/// # Safety
+///
+/// The parameter `filename` must be a C string pointing to an existing grid file.
+///
+/// # Panics
+///
+/// Panics if the file cannot be read or was written by a version of `PineAPPL` that did not yet
+/// append a metadata footer.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_read_footer(filename: *const c_char) -> Box<GridFooter> {
+    let filename = unsafe { CStr::from_ptr(filename) };
+    let filename = filename.to_string_lossy();
+    let reader = File::open(filename.as_ref()).unwrap();
+
+    Box::new(Grid::read_footer(reader).unwrap())
+}
+
+/// Return the number of bins stored in `footer`.
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_footer_bin_count(footer: *const GridFooter) -> usize {
+    let footer = unsafe { &*footer };
+
+    footer.bin_limits.bins()
+}
+
+/// Write the bin limits stored in `footer` into `bin_limits`.
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call. The parameter `bin_limits` must point to an
+/// array that is one element longer than `footer` has bins.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_footer_bin_limits(
+    footer: *const GridFooter,
+    bin_limits: *mut f64,
+) {
+    let footer = unsafe { &*footer };
+    let limits = footer.bin_limits.limits();
+    let bin_limits = unsafe { slice::from_raw_parts_mut(bin_limits, limits.len()) };
+
+    bin_limits.copy_from_slice(&limits);
+}
+
+/// Return the number of orders stored in `footer`.
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_footer_order_count(footer: *const GridFooter) -> usize {
+    let footer = unsafe { &*footer };
+
+    footer.orders.len()
+}
+
+/// Write the order parameters stored in `footer` into `order_params`.
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call. The pointer `order_params` must point to an
+/// array as large as four times the number of orders in `footer`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_footer_order_params(
+    footer: *const GridFooter,
+    order_params: *mut u32,
+) {
+    let footer = unsafe { &*footer };
+    let orders = &footer.orders;
+    let order_params = unsafe { slice::from_raw_parts_mut(order_params, 4 * orders.len()) };
+
+    for (i, order) in orders.iter().enumerate() {
+        order_params[4 * i] = order.alphas;
+        order_params[4 * i + 1] = order.alpha;
+        order_params[4 * i + 2] = order.logxir;
+        order_params[4 * i + 3] = order.logxif;
+    }
+}
+
+/// Return the channels stored in `footer` as a luminosity function. The returned object must be
+/// deleted with `pineappl_lumi_delete`.
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_footer_lumi(footer: *const GridFooter) -> Box<Lumi> {
+    let footer = unsafe { &*footer };
+
+    Box::new(Lumi(footer.channels.clone()))
+}
+
+/// Return the value for `key` stored in `footer`. If `key` isn't found, an empty string will be
+/// returned. After usage the string must be deallocated using [`pineappl_string_delete`].
+///
+/// # Safety
+///
+/// If `footer` does not point to a valid `GridFooter` object, for example when `footer` is the
+/// null pointer, this function is not safe to call. The parameter `key` must be non-`NULL` and a
+/// valid C string.
+///
+/// # Panics
+///
+/// TODO
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_footer_key_value(
+    footer: *const GridFooter,
+    key: *const c_char,
+) -> *mut c_char {
+    let footer = unsafe { &*footer };
+    let key = unsafe { CStr::from_ptr(key) };
+    let key = key.to_string_lossy();
+
+    CString::new(
+        footer
+            .key_values
+            .as_ref()
+            .map_or("", |kv| kv.get(key.as_ref()).map_or("", String::as_str)),
+    )
+    .unwrap()
+    .into_raw()
+}
+
+/// Delete a grid footer previously read with `pineappl_grid_read_footer`.
+#[no_mangle]
+#[allow(unused_variables)]
+pub extern "C" fn pineappl_grid_footer_delete(footer: Option<Box<GridFooter>>) {}
+
 /// Merges the bins of corresponding to the indices from the half-open interval `[from, to]` into a
 /// single bin.
 ///
@@ -773,6 +1979,47 @@ pub unsafe extern "C" fn pineappl_grid_merge_and_delete(grid: *mut Grid, other:
     }
 }
 
+/// Reads the grids stored in the `count` files given in `paths` and merges them into a single
+/// grid, which is returned. The files are read and merged one at a time, so that at no point more
+/// than two grids are held in memory; this allows merging an arbitrary number of files with
+/// bounded memory usage, in contrast to reading all grids first and merging them afterwards.
+///
+/// # Safety
+///
+/// The parameter `paths` must be an array of `count` non-`NULL` C strings, each naming a file that
+/// was written with `pineappl_grid_write`.
+///
+/// # Panics
+///
+/// Panics if `count` is zero, if any file cannot be read or if any grid cannot be merged into the
+/// first one.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_merge_files(
+    count: usize,
+    paths: *const *const c_char,
+) -> Box<Grid> {
+    assert_ne!(count, 0);
+
+    let paths = unsafe { slice::from_raw_parts(paths, count) };
+
+    let mut result: Option<Grid> = None;
+
+    for &path in paths {
+        let filename = unsafe { CStr::from_ptr(path) };
+        let filename = filename.to_string_lossy();
+        let reader = File::open(filename.as_ref()).unwrap();
+        let grid = Grid::read(reader).unwrap();
+
+        // the previous file's grid has already been dropped at this point
+        match &mut result {
+            None => result = Some(grid),
+            Some(result) => result.merge(grid).unwrap(),
+        }
+    }
+
+    Box::new(result.unwrap())
+}
+
 /// Scale all grids in `grid` by `factor`.
 ///
 /// # Safety
@@ -899,6 +2146,87 @@ pub unsafe extern "C" fn pineappl_grid_key_value(
     .into_raw()
 }
 
+/// Returns a borrowed view of the value for `key` stored in `grid` and writes its length into
+/// `length`. In contrast to `pineappl_grid_key_value` no string is allocated, so nothing has to be
+/// deallocated afterwards. The returned pointer is *not* NUL-terminated; it stays valid until the
+/// metadata of `grid` is modified or the grid is deleted. If `key` isn't found, `NULL` is returned
+/// and `length` is set to zero.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the `NULL`
+/// pointer, this function is not safe to call. The parameter `key` must be non-`NULL` and a valid
+/// C string, and `length` must point to a writable `size_t`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_key_value_view(
+    grid: *const Grid,
+    key: *const c_char,
+    length: *mut usize,
+) -> *const c_char {
+    let grid = unsafe { &*grid };
+    let key = unsafe { CStr::from_ptr(key) };
+    let key = key.to_string_lossy();
+    let length = unsafe { &mut *length };
+
+    if let Some(value) = grid.key_values().and_then(|kv| kv.get(key.as_ref())) {
+        *length = value.len();
+        value.as_ptr().cast()
+    } else {
+        *length = 0;
+        ptr::null()
+    }
+}
+
+/// Returns the number of key-value pairs stored in `grid`. See `pineappl_grid_key_values`.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_key_value_count(grid: *const Grid) -> usize {
+    let grid = unsafe { &*grid };
+
+    grid.key_values().map_or(0, HashMap::len)
+}
+
+/// Writes borrowed views of all key-value pairs of `grid` into the given arrays with a single
+/// call. The pairs are written in no particular order. Like for `pineappl_grid_key_value_view`
+/// the pointers are *not* NUL-terminated, nothing has to be deallocated, and the views stay valid
+/// until the metadata of `grid` is modified or the grid is deleted.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. All four array parameters must point to arrays that are at
+/// least as long as the value returned by `pineappl_grid_key_value_count`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_grid_key_values(
+    grid: *const Grid,
+    keys: *mut *const c_char,
+    key_lengths: *mut usize,
+    values: *mut *const c_char,
+    value_lengths: *mut usize,
+) {
+    let grid = unsafe { &*grid };
+    let count = grid.key_values().map_or(0, HashMap::len);
+    let keys = unsafe { slice::from_raw_parts_mut(keys, count) };
+    let key_lengths = unsafe { slice::from_raw_parts_mut(key_lengths, count) };
+    let values = unsafe { slice::from_raw_parts_mut(values, count) };
+    let value_lengths = unsafe { slice::from_raw_parts_mut(value_lengths, count) };
+
+    if let Some(kv) = grid.key_values() {
+        for (index, (key, value)) in kv.iter().enumerate() {
+            keys[index] = key.as_ptr().cast();
+            key_lengths[index] = key.len();
+            values[index] = value.as_ptr().cast();
+            value_lengths[index] = value.len();
+        }
+    }
+}
+
 /// Sets an internal key-value pair for the grid.
 ///
 /// # Safety
@@ -991,6 +2319,80 @@ pub unsafe extern "C" fn pineappl_grid_write(grid: *const Grid, filename: *const
     }
 }
 
+/// Handle for a grid write running on a background thread. See `pineappl_grid_write_async`.
+pub struct GridWriteHandle {
+    thread: thread::JoinHandle<()>,
+}
+
+/// Write `grid` to a file with name `filename` on a background thread. The grid is snapshotted
+/// before this function returns, so the caller may immediately continue filling `grid`; the
+/// expensive compression and IO do not run on the calling thread. If `compress` is `true` the file
+/// is LZ4-compressed — independently of the file name extension, in contrast to
+/// `pineappl_grid_write` — otherwise it is written uncompressed, which is faster and therefore
+/// suited for frequent checkpoints. The returned handle must be passed to
+/// `pineappl_grid_write_wait`, which also reports errors of the background thread; overwriting a
+/// file before an earlier write of it has been waited on is undefined.
+///
+/// # Safety
+///
+/// If `grid` does not point to a valid `Grid` object, for example when `grid` is the null pointer,
+/// this function is not safe to call. The parameter `filename` must be a non-`NULL`, non-empty,
+/// and valid C string pointing to a non-existing, or writable file.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_write_async(
+    grid: *const Grid,
+    filename: *const c_char,
+    compress: bool,
+) -> Box<GridWriteHandle> {
+    let grid = unsafe { &*grid };
+    let filename = unsafe { CStr::from_ptr(filename) };
+    let filename = filename.to_string_lossy().into_owned();
+
+    // the snapshot makes the written file independent of fills happening after this call
+    let snapshot = grid.clone();
+
+    let thread = thread::spawn(move || {
+        let writer = File::create(&filename).unwrap();
+
+        if compress {
+            snapshot.write_lz4(writer).unwrap();
+        } else {
+            snapshot.write(writer).unwrap();
+        }
+    });
+
+    Box::new(GridWriteHandle { thread })
+}
+
+/// Returns `true` if the write behind `handle` has finished. This function does not block; even
+/// when it returns `true` the handle must still be passed to `pineappl_grid_write_wait`.
+///
+/// # Safety
+///
+/// The parameter `handle` must point to a valid `GridWriteHandle` object created by
+/// `pineappl_grid_write_async`.
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn pineappl_grid_write_done(handle: *const GridWriteHandle) -> bool {
+    let handle = unsafe { &*handle };
+
+    handle.thread.is_finished()
+}
+
+/// Waits until the write behind `handle` has finished and deletes the handle. If `handle` is a
+/// `NULL` pointer, this function does not do anything.
+///
+/// # Panics
+///
+/// Panics if the file could not be written.
+#[no_mangle]
+pub extern "C" fn pineappl_grid_write_wait(handle: Option<Box<GridWriteHandle>>) {
+    if let Some(handle) = handle {
+        handle.thread.join().unwrap();
+    }
+}
+
 /// Adds a linear combination of initial states to the luminosity function `lumi`.
 ///
 /// # Safety
@@ -1022,6 +2424,52 @@ pub unsafe extern "C" fn pineappl_lumi_add(
     ));
 }
 
+/// Adds `channels` linear combinations of initial states to the luminosity function `lumi` with a
+/// single call, which is faster than calling `pineappl_lumi_add` once per channel when there are
+/// many channels. The array `combinations` gives the number of combinations of each channel;
+/// `pdg_id_pairs` contains the PDG ids of all channels back to back and `factors` the
+/// corresponding factors. If `factors` is `NULL`, all factors are set to one.
+///
+/// # Safety
+///
+/// The parameter `lumi` must point to a valid `Lumi` object created by `pineappl_lumi_new`.
+/// `combinations` must be an array with length `channels`, `pdg_id_pairs` an array with length
+/// `2 * (combinations[0] + ... + combinations[channels - 1])`, and `factors`, unless it is `NULL`,
+/// an array with length `combinations[0] + ... + combinations[channels - 1]`.
+#[no_mangle]
+pub unsafe extern "C" fn pineappl_lumi_add_many(
+    lumi: *mut Lumi,
+    channels: usize,
+    combinations: *const usize,
+    pdg_id_pairs: *const i32,
+    factors: *const f64,
+) {
+    let lumi = unsafe { &mut *lumi };
+    let combinations = unsafe { slice::from_raw_parts(combinations, channels) };
+    let total: usize = combinations.iter().sum();
+    let pdg_id_pairs = unsafe { slice::from_raw_parts(pdg_id_pairs, 2 * total) };
+    let factors = if factors.is_null() {
+        vec![1.0; total]
+    } else {
+        unsafe { slice::from_raw_parts(factors, total) }.to_vec()
+    };
+
+    lumi.0.reserve(channels);
+
+    let mut offset = 0;
+
+    for &entries in combinations {
+        lumi.0.push(Channel::new(
+            pdg_id_pairs[2 * offset..2 * (offset + entries)]
+                .chunks(2)
+                .zip(&factors[offset..offset + entries])
+                .map(|x| (x.0[0], x.0[1], *x.1))
+                .collect(),
+        ));
+        offset += entries;
+    }
+}
+
 /// Returns the number of combinations of the luminosity function `lumi` for the specified entry.
 ///
 /// # Safety
@@ -249,6 +249,12 @@ pub fn convert_into_applgrid(
 
                 let mut weightgrid = ffi::igrid_weightgrid(igrid.pin_mut(), lumi);
 
+                // collect all weights and write them with a single FFI call
+                let mut x = Vec::new();
+                let mut y = Vec::new();
+                let mut z = Vec::new();
+                let mut values = Vec::new();
+
                 for ((iq2, ix1, ix2), value) in subgrid.indexed_iter() {
                     let appl_q2_idx = appl_q2_idx[iq2];
 
@@ -263,19 +269,18 @@ pub fn convert_into_applgrid(
                         continue;
                     }
 
-                    ffi::sparse_matrix_set(
-                        weightgrid.as_mut(),
-                        appl_q2_idx,
-                        appl_x1_idx[ix1],
-                        if has_pdf1 && has_pdf2 {
-                            appl_x2_idx[ix2]
-                        } else {
-                            0
-                        },
-                        factor * value,
-                    );
+                    x.push(appl_q2_idx);
+                    y.push(appl_x1_idx[ix1]);
+                    z.push(if has_pdf1 && has_pdf2 {
+                        appl_x2_idx[ix2]
+                    } else {
+                        0
+                    });
+                    values.push(factor * value);
                 }
 
+                ffi::sparse_matrix_set_bulk(weightgrid.as_mut(), &x, &y, &z, &values);
+
                 // TODO: is this call needed?
                 weightgrid.trim();
             }
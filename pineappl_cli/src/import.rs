@@ -5,8 +5,11 @@ use clap::builder::{PossibleValuesParser, TypedValueParser};
 use clap::{Parser, ValueHint};
 use lhapdf::Pdf;
 use pineappl::grid::Grid;
+use rayon::ThreadPoolBuilder;
+use std::num::NonZeroUsize;
 use std::path::{Path, PathBuf};
 use std::process::ExitCode;
+use std::thread;
 
 #[cfg(feature = "applgrid")]
 mod applgrid;
@@ -237,6 +240,9 @@ pub struct Opts {
     /// factorization scale.
     #[arg(long, value_parser = PossibleValuesParser::new(fnlo_mu_possible_values()))]
     fnlo_muf: Option<String>,
+    /// Number of threads to utilize.
+    #[arg(default_value_t = thread::available_parallelism().map_or(1, NonZeroUsize::get), long)]
+    threads: usize,
     /// Set the number of fractional digits shown for absolute numbers.
     #[arg(default_value_t = 7, long, value_name = "ABS")]
     digits_abs: usize,
@@ -257,6 +263,11 @@ impl Subcommand for Opts {
 
         let mut conv_funs = helpers::create_conv_funs(&self.conv_funs)?;
 
+        ThreadPoolBuilder::new()
+            .num_threads(self.threads)
+            .build_global()
+            .unwrap();
+
         // TODO: figure out `member` from `self.pdfset`
         let (grid_type, mut grid, reference_results, scale_variations) = convert_grid(
             &self.input,
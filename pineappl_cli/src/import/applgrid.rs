@@ -5,8 +5,9 @@ use pineappl::convolutions::Convolution;
 use pineappl::grid::Grid;
 use pineappl::import_only_subgrid::ImportOnlySubgridV2;
 use pineappl::sparse_array3::SparseArray3;
-use pineappl::subgrid::{Mu2, SubgridParams};
+use pineappl::subgrid::{Mu2, SubgridEnum, SubgridParams};
 use pineappl_applgrid::ffi::{self, grid};
+use rayon::prelude::*;
 use std::f64::consts::TAU;
 use std::pin::Pin;
 use std::ptr;
@@ -130,77 +131,107 @@ pub fn convert_applgrid(grid: Pin<&mut grid>, alpha: u32, dis_pid: i32) -> Resul
             pgrid.set_convolution(1, Convolution::None);
         }
 
-        for bin in 0..grid.Nobs_internal() {
-            let igrid = grid.weightgrid(i.try_into().unwrap(), bin);
-            let igrid = unsafe { &*igrid };
-            let reweight = ffi::igrid_m_reweight(igrid);
-
-            let mu2_values: Vec<_> = (0..igrid.Ntau())
-                .map(|i| {
-                    let q2 = igrid.getQ2(i);
-                    Mu2 { ren: q2, fac: q2 }
-                })
-                .collect();
-            let x1_values: Vec<_> = (0..igrid.Ny1())
-                .map(|i| igrid.getx1(i).clamp(0.0, 1.0))
-                .collect();
-            let x1_weights: Vec<_> = x1_values
-                .iter()
-                .map(|&x1| if reweight { ffi::weightfun(x1) } else { 1.0 })
-                .collect();
-            let x2_values: Vec<_> = (0..igrid.Ny2())
-                .map(|i| igrid.getx2(i).clamp(0.0, 1.0))
-                .collect();
-            let x2_weights: Vec<_> = x2_values
-                .iter()
-                .map(|&x2| {
-                    if reweight && !grid.isDIS() {
-                        ffi::weightfun(x2)
-                    } else {
-                        1.0
+        // the igrids are read-only during the conversion, so the bins can be walked in parallel;
+        // references to `cxx` types aren't `Send`, so the workers receive the grid as a raw
+        // address
+        let grid_addr = (&*grid as *const grid) as usize;
+        let order_index: i32 = i.try_into().unwrap();
+        let is_dis = grid.isDIS();
+
+        let bin_subgrids: Vec<(i32, Vec<(usize, SubgridEnum)>)> = (0..grid.Nobs_internal())
+            .into_par_iter()
+            .map(|bin| {
+                let grid = unsafe { &*(grid_addr as *const grid) };
+                let igrid = grid.weightgrid(order_index, bin);
+                let igrid = unsafe { &*igrid };
+                let reweight = ffi::igrid_m_reweight(igrid);
+
+                let mu2_values: Vec<_> = (0..igrid.Ntau())
+                    .map(|i| {
+                        let q2 = igrid.getQ2(i);
+                        Mu2 { ren: q2, fac: q2 }
+                    })
+                    .collect();
+                let x1_values: Vec<_> = (0..igrid.Ny1())
+                    .map(|i| igrid.getx1(i).clamp(0.0, 1.0))
+                    .collect();
+                let x1_weights: Vec<_> = x1_values
+                    .iter()
+                    .map(|&x1| if reweight { ffi::weightfun(x1) } else { 1.0 })
+                    .collect();
+                let x2_values: Vec<_> = (0..igrid.Ny2())
+                    .map(|i| igrid.getx2(i).clamp(0.0, 1.0))
+                    .collect();
+                let x2_weights: Vec<_> = x2_values
+                    .iter()
+                    .map(|&x2| {
+                        if reweight && !is_dis {
+                            ffi::weightfun(x2)
+                        } else {
+                            1.0
+                        }
+                    })
+                    .collect();
+
+                let mut subgrids = Vec::new();
+
+                for lumi in 0..lumis_len {
+                    let matrix = igrid.weightgrid(lumi.try_into().unwrap());
+
+                    if matrix.is_null() {
+                        continue;
                     }
-                })
-                .collect();
 
-            for lumi in 0..lumis_len {
-                let matrix = igrid.weightgrid(lumi.try_into().unwrap());
+                    let matrix = unsafe { &*matrix };
 
-                if matrix.is_null() {
-                    continue;
-                }
+                    let mut array =
+                        SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
 
-                let matrix = unsafe { &*matrix };
+                    // export all non-zero elements in one call instead of crossing the FFI once
+                    // per (itau, ix1, ix2) cell
+                    let mut indices = Vec::new();
+                    let mut values = Vec::new();
 
-                let mut array =
-                    SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
+                    ffi::sparse_matrix_export(
+                        matrix,
+                        mu2_values.len().try_into().unwrap(),
+                        x1_values.len().try_into().unwrap(),
+                        x2_values.len().try_into().unwrap(),
+                        &mut indices,
+                        &mut values,
+                    );
 
-                for itau in 0..mu2_values.len() {
-                    for ix1 in 0..x1_values.len() {
-                        for ix2 in 0..x2_values.len() {
-                            let value = ffi::sparse_matrix_get(
-                                matrix,
-                                itau.try_into().unwrap(),
-                                ix1.try_into().unwrap(),
-                                ix2.try_into().unwrap(),
-                            );
+                    for (&index, &value) in indices.iter().zip(values.iter()) {
+                        let index: usize = index.try_into().unwrap();
+                        let ix2 = index % x2_values.len();
+                        let ix1 = (index / x2_values.len()) % x1_values.len();
+                        let itau = index / (x1_values.len() * x2_values.len());
 
-                            if value != 0.0 {
-                                array[[itau, ix1, ix2]] = value * x1_weights[ix1] * x2_weights[ix2];
-                            }
-                        }
+                        array[[itau, ix1, ix2]] = value * x1_weights[ix1] * x2_weights[ix2];
                     }
-                }
 
-                if !array.is_empty() {
-                    pgrid.subgrids_mut()[[0, bin.try_into().unwrap(), lumi]] =
-                        ImportOnlySubgridV2::new(
-                            array,
-                            mu2_values.clone(),
-                            x1_values.clone(),
-                            x2_values.clone(),
-                        )
-                        .into();
+                    if !array.is_empty() {
+                        subgrids.push((
+                            lumi,
+                            ImportOnlySubgridV2::new(
+                                array,
+                                mu2_values.clone(),
+                                x1_values.clone(),
+                                x2_values.clone(),
+                            )
+                            .into(),
+                        ));
+                    }
                 }
+
+                (bin, subgrids)
+            })
+            .collect();
+
+        // stitch the independently produced subgrids into the grid serially
+        for (bin, subgrids) in bin_subgrids {
+            for (lumi, subgrid) in subgrids {
+                pgrid.subgrids_mut()[[0, bin.try_into().unwrap(), lumi]] = subgrid;
             }
         }
 
@@ -1,6 +1,5 @@
 use anyhow::Result;
 use itertools::Itertools;
-use ndarray::s;
 use pineappl::bin::BinRemapper;
 use pineappl::boc::{Channel, Order};
 use pineappl::convolutions::Convolution;
@@ -12,6 +11,7 @@ use pineappl_fastnlo::ffi::{
     self, fastNLOCoeffAddBase, fastNLOCoeffAddFix, fastNLOCoeffAddFlex, fastNLOLHAPDF,
     fastNLOPDFLinearCombinations, EScaleFunctionalForm,
 };
+use rayon::prelude::*;
 use std::f64::consts::TAU;
 
 fn pid_to_pdg_id(pid: i32) -> i32 {
@@ -54,33 +54,36 @@ fn create_lumi(
     if lumis.is_empty() {
         let nsubproc = table.GetNSubproc().try_into().unwrap();
 
-        let mut xfx1 = [0.0; 13];
-        let mut xfx2 = [0.0; 13];
-
         let mut entries = Vec::new();
         entries.resize(nsubproc, Vec::new());
 
-        for a in 0..13 {
-            xfx1[a] = 1.0;
+        // probe all 13x13 basis-vector combinations with a single batched FFI call
+        let mut xfx1 = vec![0.0; 13 * 13 * 13];
+        let mut xfx2 = vec![0.0; 13 * 13 * 13];
 
+        for a in 0..13 {
             for b in 0..13 {
-                xfx2[b] = 1.0;
+                let row = 13 * a + b;
+                xfx1[13 * row + a] = 1.0;
+                xfx2[13 * row + b] = 1.0;
+            }
+        }
 
-                let lumi = ffi::CalcPDFLinearCombination(comb, table, &xfx1, &xfx2, false);
+        let mut lumi = Vec::new();
+        ffi::CalcPDFLinearCombinationBatch(comb, table, &xfx1, &xfx2, false, &mut lumi);
 
-                assert!(lumi.len() == nsubproc);
+        assert_eq!(lumi.len(), 13 * 13 * nsubproc);
 
-                for (i, l) in lumi.iter().copied().enumerate().filter(|(_, l)| *l != 0.0) {
-                    let ap = pid_to_pdg_id(i32::try_from(a).unwrap() - 6);
-                    let bp = pid_to_pdg_id(i32::try_from(b).unwrap() - 6);
+        for (row, lumi) in lumi.chunks_exact(nsubproc).enumerate() {
+            let a = row / 13;
+            let b = row % 13;
 
-                    entries[i].push((ap, bp, l));
-                }
+            for (i, l) in lumi.iter().copied().enumerate().filter(|(_, l)| *l != 0.0) {
+                let ap = pid_to_pdg_id(i32::try_from(a).unwrap() - 6);
+                let bp = pid_to_pdg_id(i32::try_from(b).unwrap() - 6);
 
-                xfx2[b] = 0.0;
+                entries[i].push((ap, bp, l));
             }
-
-            xfx1[a] = 0.0;
         }
 
         lumis = entries.into_iter().map(Channel::new).collect();
@@ -130,90 +133,121 @@ fn convert_coeff_add_fix(
 
     let total_scalenodes: usize = table.GetTotalScalenodes().try_into().unwrap();
 
-    for obs in 0..table_as_add_base.GetNObsBin() {
-        let x1_values = ffi::GetXNodes1(table_as_add_base, obs);
+    // the coefficient tables are read-only during the conversion, so they can be shared across
+    // threads; references to `cxx` types aren't `Send`, so pass them as raw addresses
+    let table_addr = table as *const fastNLOCoeffAddFix as usize;
+    let base_addr = table_as_add_base as *const fastNLOCoeffAddBase as usize;
 
-        // TODO: is this the correct assumption?
-        let x2_values = if table.GetNxtot2(0) == -1 {
-            x1_values.clone()
-        } else {
-            ffi::GetXNodes2(table_as_add_base, obs)
-        };
+    let bin_subgrids: Vec<_> = (0..table_as_add_base.GetNObsBin())
+        .into_par_iter()
+        .map(|obs| {
+            let table = unsafe { &*(table_addr as *const fastNLOCoeffAddFix) };
+            let table_as_add_base = unsafe { &*(base_addr as *const fastNLOCoeffAddBase) };
 
-        for subproc in 0..table_as_add_base.GetNSubproc() {
-            let factor = table_as_add_base.GetNevt(obs, subproc);
+            let x1_values = ffi::GetXNodes1(table_as_add_base, obs);
 
-            for j in 0..table.GetTotalScalevars() {
-                // TODO: for the time being we only extract the central scale result
-                if table.GetScaleFactor(j) != 1.0 {
-                    continue;
-                }
+            // TODO: is this the correct assumption?
+            let x2_values = if table.GetNxtot2(0) == -1 {
+                x1_values.clone()
+            } else {
+                ffi::GetXNodes2(table_as_add_base, obs)
+            };
 
-                let q_values = ffi::GetScaleNodes(table, obs, j);
-                let mu2_values: Vec<_> = q_values
-                    .iter()
-                    .map(|q| Mu2 {
-                        ren: q * q,
-                        fac: q * q,
-                    })
-                    .collect();
-
-                let mut array =
-                    SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
-
-                // TODO: figure out what the general case is supposed to be
-                assert_eq!(j, 0);
-
-                for mu2_slice in 0..total_scalenodes {
-                    let mut ix1: usize = 0;
-                    let mut ix2: usize = 0;
-
-                    for ix in 0..table.GetNxmax(obs) {
-                        assert_eq!(
-                            table.GetXIndex(obs, ix1.try_into().unwrap(), ix2.try_into().unwrap()),
-                            ix
-                        );
-
-                        let value =
-                            table.GetSigmaTilde(obs, j, mu2_slice.try_into().unwrap(), ix, subproc);
-
-                        if value != 0.0 {
-                            array[[mu2_slice, ix2, ix1]] =
-                                value / factor * x1_values[ix1] * x2_values[ix2];
-                        }
+            let mut subgrids = Vec::new();
 
-                        ix1 += 1;
+            for subproc in 0..table_as_add_base.GetNSubproc() {
+                let factor = table_as_add_base.GetNevt(obs, subproc);
 
-                        match table.GetNPDFDim() {
-                            2 => {
-                                if ix1 == x1_values.len() {
-                                    ix1 = 0;
-                                    ix2 += 1;
-                                }
+                for j in 0..table.GetTotalScalevars() {
+                    // TODO: for the time being we only extract the central scale result
+                    if table.GetScaleFactor(j) != 1.0 {
+                        continue;
+                    }
+
+                    let q_values = ffi::GetScaleNodes(table, obs, j);
+                    let mu2_values: Vec<_> = q_values
+                        .iter()
+                        .map(|q| Mu2 {
+                            ren: q * q,
+                            fac: q * q,
+                        })
+                        .collect();
+
+                    let mut array =
+                        SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
+
+                    // TODO: figure out what the general case is supposed to be
+                    assert_eq!(j, 0);
+
+                    for mu2_slice in 0..total_scalenodes {
+                        let mut ix1: usize = 0;
+                        let mut ix2: usize = 0;
+
+                        for ix in 0..table.GetNxmax(obs) {
+                            assert_eq!(
+                                table.GetXIndex(
+                                    obs,
+                                    ix1.try_into().unwrap(),
+                                    ix2.try_into().unwrap()
+                                ),
+                                ix
+                            );
+
+                            let value = table.GetSigmaTilde(
+                                obs,
+                                j,
+                                mu2_slice.try_into().unwrap(),
+                                ix,
+                                subproc,
+                            );
+
+                            if value != 0.0 {
+                                array[[mu2_slice, ix2, ix1]] =
+                                    value / factor * x1_values[ix1] * x2_values[ix2];
                             }
-                            1 => {
-                                if ix1 > ix2 {
-                                    ix1 = 0;
-                                    ix2 += 1;
+
+                            ix1 += 1;
+
+                            match table.GetNPDFDim() {
+                                2 => {
+                                    if ix1 == x1_values.len() {
+                                        ix1 = 0;
+                                        ix2 += 1;
+                                    }
+                                }
+                                1 => {
+                                    if ix1 > ix2 {
+                                        ix1 = 0;
+                                        ix2 += 1;
+                                    }
                                 }
+                                n => unimplemented!("GetNPDFDim = {n} is not supported"),
                             }
-                            n => unimplemented!("GetNPDFDim = {n} is not supported"),
                         }
                     }
-                }
 
-                if !array.is_empty() {
-                    grid.subgrids_mut()
-                        [[0, obs.try_into().unwrap(), subproc.try_into().unwrap()]] =
-                        ImportOnlySubgridV2::new(
-                            array,
-                            mu2_values,
-                            x1_values.clone(),
-                            x2_values.clone(),
-                        )
-                        .into();
+                    if !array.is_empty() {
+                        subgrids.push((
+                            usize::try_from(subproc).unwrap(),
+                            ImportOnlySubgridV2::new(
+                                array,
+                                mu2_values,
+                                x1_values.clone(),
+                                x2_values.clone(),
+                            )
+                            .into(),
+                        ));
+                    }
                 }
             }
+
+            subgrids
+        })
+        .collect();
+
+    for (obs, subgrids) in bin_subgrids.into_iter().enumerate() {
+        for (subproc, subgrid) in subgrids {
+            grid.subgrids_mut()[[0, obs, subproc]] = subgrid;
         }
     }
 
@@ -278,106 +312,133 @@ fn convert_coeff_add_flex(
 
     let rescale = 0.1_f64.powi(table.GetIXsectUnits() - ipub_units);
 
-    for obs in 0..bins {
-        let scale_nodes1 = ffi::GetScaleNodes1(table, obs.try_into().unwrap());
-        let scale_nodes2 = ffi::GetScaleNodes2(table, obs.try_into().unwrap());
-        let x1_values = ffi::GetXNodes1(table_as_add_base, obs.try_into().unwrap());
-        let x2_values = if npdf > 1 {
-            ffi::GetXNodes2(table_as_add_base, obs.try_into().unwrap())
-        } else {
-            vec![1.0]
-        };
+    let nx_all = ffi::GetNxAll(table);
 
-        let mu2_values: Vec<_> = scale_nodes1
-            .iter()
-            .cartesian_product(scale_nodes2.iter())
-            .map(|(&s1, &s2)| Mu2 {
-                ren: mur_ff.compute_scale(s1, s2),
-                fac: muf_ff.compute_scale(s1, s2),
-            })
-            .collect();
-        let nx = ffi::GetNx(table, obs);
-
-        for subproc in 0..table_as_add_base.GetNSubproc() {
-            let factor = rescale / table_as_add_base.GetNevt(obs.try_into().unwrap(), subproc);
-            let mut arrays =
-                vec![
-                    SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
-                    orders_len
-                ];
-
-            for (mu2_slice, (is1, is2)) in (0..scale_nodes1.len())
-                .cartesian_product(0..scale_nodes2.len())
-                .enumerate()
-            {
-                let logmur2 = mu2_values[mu2_slice].ren.ln();
-                let logmuf2 = mu2_values[mu2_slice].fac.ln();
-                let logs00 = [
-                    logmur2,
-                    logmuf2,
-                    logmur2 * logmur2,
-                    logmuf2 * logmuf2,
-                    logmur2 * logmuf2,
-                ];
-                let logs10 = [2.0 * logmur2, 0.0, logmuf2];
-                let logs01 = [0.0, 2.0 * logmuf2, logmur2];
-
-                for ix in 0..nx {
-                    // TODO: is this always correct? Isn't there a member function for it?
-                    let ix1 = ix % x1_values.len();
-                    let ix2 = ix / x1_values.len();
-                    let mut values = [0.0; 6];
-
-                    for (index, value) in values.iter_mut().enumerate().take(orders_len) {
-                        *value = ffi::GetSigmaTilde(table, index, obs, ix, is1, is2, subproc);
-                    }
+    // the coefficient tables are read-only during the conversion, so they can be shared across
+    // threads; references to `cxx` types aren't `Send`, so pass them as raw addresses
+    let table_addr = table as *const fastNLOCoeffAddFlex as usize;
+    let base_addr = table_as_add_base as *const fastNLOCoeffAddBase as usize;
 
-                    values[0] += values[1..]
-                        .iter()
-                        .zip(logs00.iter())
-                        .map(|(value, log)| value * log)
-                        .sum::<f64>();
-                    values[1] += values[3..]
-                        .iter()
-                        .zip(logs10.iter())
-                        .map(|(value, log)| value * log)
-                        .sum::<f64>();
-                    values[2] += values[3..]
-                        .iter()
-                        .zip(logs01.iter())
-                        .map(|(value, log)| value * log)
-                        .sum::<f64>();
+    let bin_subgrids: Vec<_> = (0..bins)
+        .into_par_iter()
+        .map(|obs| {
+            let table = unsafe { &*(table_addr as *const fastNLOCoeffAddFlex) };
+            let table_as_add_base = unsafe { &*(base_addr as *const fastNLOCoeffAddBase) };
 
-                    for (value, array) in values
-                        .iter()
-                        .copied()
-                        .zip(arrays.iter_mut())
-                        .filter(|(value, _)| *value != 0.0)
-                    {
-                        array[[mu2_slice, ix1, ix2]] =
-                            value * factor * x1_values[ix1] * x2_values[ix2];
+            let scale_nodes1 = ffi::GetScaleNodes1(table, obs.try_into().unwrap());
+            let scale_nodes2 = ffi::GetScaleNodes2(table, obs.try_into().unwrap());
+            let x1_values = ffi::GetXNodes1(table_as_add_base, obs.try_into().unwrap());
+            let x2_values = if npdf > 1 {
+                ffi::GetXNodes2(table_as_add_base, obs.try_into().unwrap())
+            } else {
+                vec![1.0]
+            };
+
+            let mu2_values: Vec<_> = scale_nodes1
+                .iter()
+                .cartesian_product(scale_nodes2.iter())
+                .map(|(&s1, &s2)| Mu2 {
+                    ren: mur_ff.compute_scale(s1, s2),
+                    fac: muf_ff.compute_scale(s1, s2),
+                })
+                .collect();
+            let nx = nx_all[obs];
+
+            let mut subgrids = Vec::new();
+
+            for subproc in 0..table_as_add_base.GetNSubproc() {
+                let factor = rescale / table_as_add_base.GetNevt(obs.try_into().unwrap(), subproc);
+                let mut arrays =
+                    vec![
+                        SparseArray3::new(mu2_values.len(), x1_values.len(), x2_values.len());
+                        orders_len
+                    ];
+
+                for (mu2_slice, (is1, is2)) in (0..scale_nodes1.len())
+                    .cartesian_product(0..scale_nodes2.len())
+                    .enumerate()
+                {
+                    let logmur2 = mu2_values[mu2_slice].ren.ln();
+                    let logmuf2 = mu2_values[mu2_slice].fac.ln();
+                    let logs00 = [
+                        logmur2,
+                        logmuf2,
+                        logmur2 * logmur2,
+                        logmuf2 * logmuf2,
+                        logmur2 * logmuf2,
+                    ];
+                    let logs10 = [2.0 * logmur2, 0.0, logmuf2];
+                    let logs01 = [0.0, 2.0 * logmuf2, logmur2];
+
+                    // one call copies the sigma-tilde values of all orders and x-nodes for this
+                    // scale-node pair, instead of a call per (order, x-node) combination
+                    let sigma_tilde =
+                        ffi::GetSigmaTildeSlice(table, orders_len, obs, is1, is2, subproc);
+
+                    for ix in 0..nx {
+                        // TODO: is this always correct? Isn't there a member function for it?
+                        let ix1 = ix % x1_values.len();
+                        let ix2 = ix / x1_values.len();
+                        let mut values = [0.0; 6];
+
+                        for (index, value) in values.iter_mut().enumerate().take(orders_len) {
+                            *value = sigma_tilde[index * nx + ix];
+                        }
+
+                        values[0] += values[1..]
+                            .iter()
+                            .zip(logs00.iter())
+                            .map(|(value, log)| value * log)
+                            .sum::<f64>();
+                        values[1] += values[3..]
+                            .iter()
+                            .zip(logs10.iter())
+                            .map(|(value, log)| value * log)
+                            .sum::<f64>();
+                        values[2] += values[3..]
+                            .iter()
+                            .zip(logs01.iter())
+                            .map(|(value, log)| value * log)
+                            .sum::<f64>();
+
+                        for (value, array) in values
+                            .iter()
+                            .copied()
+                            .zip(arrays.iter_mut())
+                            .filter(|(value, _)| *value != 0.0)
+                        {
+                            array[[mu2_slice, ix1, ix2]] =
+                                value * factor * x1_values[ix1] * x2_values[ix2];
+                        }
                     }
                 }
-            }
 
-            for (subgrid, array) in grid
-                .subgrids_mut()
-                .slice_mut(s![.., obs, usize::try_from(subproc).unwrap()])
-                .iter_mut()
-                .zip(arrays.into_iter())
-            {
-                if array.is_empty() {
-                    continue;
-                }
+                for (order, array) in arrays.into_iter().enumerate() {
+                    if array.is_empty() {
+                        continue;
+                    }
 
-                *subgrid = ImportOnlySubgridV2::new(
-                    array,
-                    mu2_values.clone(),
-                    x1_values.clone(),
-                    x2_values.clone(),
-                )
-                .into();
+                    subgrids.push((
+                        order,
+                        usize::try_from(subproc).unwrap(),
+                        ImportOnlySubgridV2::new(
+                            array,
+                            mu2_values.clone(),
+                            x1_values.clone(),
+                            x2_values.clone(),
+                        )
+                        .into(),
+                    ));
+                }
             }
+
+            subgrids
+        })
+        .collect();
+
+    for (obs, subgrids) in bin_subgrids.into_iter().enumerate() {
+        for (order, subproc, subgrid) in subgrids {
+            grid.subgrids_mut()[[order, obs, subproc]] = subgrid;
         }
     }
 
@@ -109,6 +109,7 @@ impl Subcommand for Opts {
                         SubgridEnum::ImportOnlySubgridV1(_) => "ImportOnlySubgridV1",
                         SubgridEnum::ImportOnlySubgridV2(_) => "ImportOnlySubgridV2",
                         SubgridEnum::EmptySubgridV1(_) => "EmptySubgridV1",
+                        SubgridEnum::SinglePrecisionSubgridV1(_) => "SinglePrecisionSubgridV1",
                     }
                 ));
             }
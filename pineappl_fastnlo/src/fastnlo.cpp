@@ -1,6 +1,7 @@
 #include "pineappl_fastnlo/src/fastnlo.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <iterator>
 #include <string>
 
@@ -39,6 +40,37 @@ rust::Vec<double> CalcPDFLinearCombination(
     return std_vector_to_rust_vec(lc.CalcPDFLinearCombination(&base, fx1, fx2, pdf2IsAntiParticle));
 }
 
+void CalcPDFLinearCombinationBatch(
+    fastNLOPDFLinearCombinations const& lc,
+    fastNLOCoeffAddBase const& base,
+    rust::Slice<double const> pdfx1,
+    rust::Slice<double const> pdfx2,
+    bool pdf2IsAntiParticle,
+    rust::Vec<double>& results
+) {
+    // fastNLO's PDF interface is always 13 flavours wide
+    std::size_t const stride = 13;
+
+    assert(pdfx1.size() == pdfx2.size());
+    assert((pdfx1.size() % stride) == 0);
+
+    // the workspaces are reused across all rows instead of being reallocated per call
+    std::vector<double> fx1(stride);
+    std::vector<double> fx2(stride);
+
+    results.clear();
+
+    for (std::size_t row = 0; row != pdfx1.size() / stride; ++row)
+    {
+        std::copy(pdfx1.begin() + stride * row, pdfx1.begin() + stride * (row + 1), fx1.begin());
+        std::copy(pdfx2.begin() + stride * row, pdfx2.begin() + stride * (row + 1), fx2.begin());
+
+        auto const lumi = lc.CalcPDFLinearCombination(&base, fx1, fx2, pdf2IsAntiParticle);
+
+        std::copy(lumi.begin(), lumi.end(), std::back_inserter(results));
+    }
+}
+
 rust::Vec<double> GetScaleNodes(fastNLOCoeffAddFix const& coeffs, int iObs, int iSvar)
 {
     return std_vector_to_rust_vec(coeffs.GetScaleNodes(iObs, iSvar));
@@ -134,6 +166,50 @@ std::size_t GetNx(fastNLOCoeffAddFlex const& coeffs, std::size_t obs)
     return coeffs.GetSigmaTildes().at(0)->at(obs).size();
 }
 
+rust::Vec<std::size_t> GetNxAll(fastNLOCoeffAddFlex const& coeffs)
+{
+    auto const& sigma_tildes = coeffs.GetSigmaTildes();
+
+    rust::Vec<std::size_t> result;
+    result.reserve(sigma_tildes.at(0)->size());
+
+    for (auto const& x_nodes : *sigma_tildes.at(0))
+    {
+        result.push_back(x_nodes.size());
+    }
+
+    return result;
+}
+
+rust::Vec<double> GetSigmaTildeSlice(
+    fastNLOCoeffAddFlex const& coeffs,
+    std::size_t orders,
+    std::size_t obs,
+    std::size_t is1,
+    std::size_t is2,
+    int subproc
+) {
+    auto const& sigma_tildes = coeffs.GetSigmaTildes();
+    std::size_t const nx = sigma_tildes.at(0)->at(obs).size();
+
+    rust::Vec<double> result;
+    result.reserve(orders * nx);
+
+    // only the first `orders` sigma-tilde members are filled for this table's `NScaleDep`; the
+    // remaining ones are empty and must not be indexed
+    for (std::size_t mu = 0; mu != orders; ++mu)
+    {
+        auto const* sigma_tilde = sigma_tildes.at(mu);
+
+        for (std::size_t ix = 0; ix != nx; ++ix)
+        {
+            result.push_back(sigma_tilde->at(obs).at(ix).at(is1).at(is2).at(subproc));
+        }
+    }
+
+    return result;
+}
+
 fastNLOCoeffAddBase const& downcast_coeff_add_fix_to_base(fastNLOCoeffAddFix const& coeffs)
 {
     return coeffs;
@@ -29,6 +29,15 @@ rust::Vec<double> CalcPDFLinearCombination(
     bool pdf2IsAntiParticle
 );
 
+void CalcPDFLinearCombinationBatch(
+    fastNLOPDFLinearCombinations const& lc,
+    fastNLOCoeffAddBase const& base,
+    rust::Slice<double const> pdfx1,
+    rust::Slice<double const> pdfx2,
+    bool pdf2IsAntiParticle,
+    rust::Vec<double>& results
+);
+
 rust::Vec<double> GetScaleNodes(fastNLOCoeffAddFix const& coeffs, int iObs, int iSvar);
 
 rust::Vec<double> GetXNodes1(fastNLOCoeffAddBase const& coeffs, int iObsBin);
@@ -63,6 +72,17 @@ double GetSigmaTilde(
 
 std::size_t GetNx(fastNLOCoeffAddFlex const& coeffs, std::size_t);
 
+rust::Vec<std::size_t> GetNxAll(fastNLOCoeffAddFlex const& coeffs);
+
+rust::Vec<double> GetSigmaTildeSlice(
+    fastNLOCoeffAddFlex const& coeffs,
+    std::size_t,
+    std::size_t,
+    std::size_t,
+    std::size_t,
+    int
+);
+
 fastNLOCoeffAddBase const& downcast_coeff_add_fix_to_base(fastNLOCoeffAddFix const& coeffs);
 
 fastNLOCoeffAddBase const& downcast_coeff_add_flex_to_base(fastNLOCoeffAddFlex const& coeffs);
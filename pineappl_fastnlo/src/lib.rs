@@ -144,9 +144,18 @@ pub mod ffi {
             _: &[f64],
             _: bool,
         ) -> Vec<f64>;
+        fn CalcPDFLinearCombinationBatch(
+            _: &fastNLOPDFLinearCombinations,
+            _: &fastNLOCoeffAddBase,
+            _: &[f64],
+            _: &[f64],
+            _: bool,
+            _: &mut Vec<f64>,
+        );
 
         fn GetCrossSection(_: Pin<&mut fastNLOReader>, _: bool) -> Vec<f64>;
         fn GetNx(_: &fastNLOCoeffAddFlex, _: usize) -> usize;
+        fn GetNxAll(_: &fastNLOCoeffAddFlex) -> Vec<usize>;
         fn GetDimLabels(_: &fastNLOTable) -> Vec<String>;
         fn GetObsBinDimBounds(_: &fastNLOTable, _: u32, _: u32) -> pair_double_double;
         fn GetScDescr(_: &fastNLOTable) -> Vec<String>;
@@ -167,6 +176,14 @@ pub mod ffi {
             _: usize,
             _: i32,
         ) -> f64;
+        fn GetSigmaTildeSlice(
+            _: &fastNLOCoeffAddFlex,
+            _: usize,
+            _: usize,
+            _: usize,
+            _: usize,
+            _: i32,
+        ) -> Vec<f64>;
 
         fn downcast_coeff_add_fix_to_base(_: &fastNLOCoeffAddFix) -> &fastNLOCoeffAddBase;
         fn downcast_coeff_add_flex_to_base(_: &fastNLOCoeffAddFlex) -> &fastNLOCoeffAddBase;